@@ -0,0 +1,394 @@
+#!/usr/bin/env python3
+"""
+Benchmark harness for the C to PlantUML converter.
+
+Generates a synthetic C project at a configurable scale and times the
+pipeline stages separately:
+
+- tokenize:  CTokenizer.tokenize over every source file
+- filter:    PreprocessorEvaluator.filter_tokens over every token stream
+- parse:     CParser.parse_file over every source file
+- transform: Transformer._apply_transformations on the parsed model
+- generate:  Generator.generate from the transformed model
+
+Each stage reports seconds, files/s and peak traced memory. Results can be
+stored as a baseline and later runs compared against it; the script exits
+with status 1 when a stage is slower than the baseline by more than the
+tolerance.
+
+Usage:
+    python scripts/benchmark.py                           # default scale
+    python scripts/benchmark.py --files 2000 --include-depth 6
+    python scripts/benchmark.py --save-baseline           # store results as baseline
+    python scripts/benchmark.py --baseline artifacts/benchmark/baseline.json
+"""
+
+import argparse
+import gc
+import json
+import os
+import platform
+import random
+import shutil
+import sys
+import tempfile
+import time
+import tracemalloc
+from pathlib import Path
+from typing import Callable, Dict, List, Tuple
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+PROJECT_ROOT = os.path.dirname(SCRIPT_DIR)
+sys.path.insert(0, os.path.join(PROJECT_ROOT, "src"))
+
+from c2puml import __version__  # noqa: E402
+from c2puml.core.generator import Generator  # noqa: E402
+from c2puml.core.parser import CParser  # noqa: E402
+from c2puml.core.parser_tokenizer import CTokenizer  # noqa: E402
+from c2puml.core.preprocessor import PreprocessorEvaluator  # noqa: E402
+from c2puml.core.transformer import Transformer  # noqa: E402
+from c2puml.models import FileModel, ProjectModel  # noqa: E402
+
+DEFAULT_OUTPUT = os.path.join(PROJECT_ROOT, "artifacts", "benchmark", "results.json")
+DEFAULT_BASELINE = os.path.join(PROJECT_ROOT, "artifacts", "benchmark", "baseline.json")
+STAGES = ("tokenize", "filter", "parse", "transform", "generate")
+RESULT_FORMAT = 1
+
+PRIMITIVES = ["int", "unsigned int", "char *", "uint8_t", "uint32_t", "double", "void *"]
+
+
+# ---------------------------------------------------------------------------
+# Synthetic project generation
+# ---------------------------------------------------------------------------
+
+
+def _header_name(layer: int, index: int) -> str:
+    return f"mod_l{layer}_{index}.h"
+
+
+def _typedef_block(rnd: random.Random, prefix: str, count: int, anonymous: int,
+                   known_types: List[str]) -> Tuple[List[str], List[str]]:
+    """Return source lines and the typedef names declared by them"""
+    lines: List[str] = []
+    names: List[str] = []
+    for t in range(count):
+        kind = t % 4
+        name = f"{prefix}_t{t}_t"
+        if kind == 0:
+            lines.append(f"typedef {rnd.choice(PRIMITIVES)} {name};")
+        elif kind == 1:
+            lines.append(f"typedef enum {{ {prefix.upper()}_T{t}_A, {prefix.upper()}_T{t}_B = 4 }} {name};")
+        else:
+            keyword = "struct" if kind == 2 else "union"
+            lines.append(f"typedef {keyword} {{")
+            for f in range(rnd.randint(2, 5)):
+                field_type = rnd.choice(known_types + names) if (known_types or names) and rnd.random() < 0.4 else rnd.choice(PRIMITIVES)
+                lines.append(f"    {field_type} field_{f};")
+            for a in range(anonymous if keyword == "struct" else 0):
+                lines.append("    struct {")
+                lines.append("        int inner_x;")
+                lines.append(f"        {rnd.choice(PRIMITIVES)} inner_y;")
+                lines.append(f"    }} nested_{a};")
+            lines.append(f"}} {name};")
+        names.append(name)
+    return lines, names
+
+
+def _wrap_in_ifs(lines: List[str], nesting: int, macro: str) -> List[str]:
+    """Wrap lines in nested #if blocks that bench_config.h enables, each with an #else branch"""
+    for level in range(nesting):
+        condition = f"{macro}_{level} > {level}" if level % 2 == 0 else f"defined({macro}_{level})"
+        lines = (
+            [f"#if {condition}"] + lines + ["#else", f"/* {macro} level {level} disabled */", "#endif"]
+        )
+    return lines
+
+
+def generate_project(root: Path, files: int, include_depth: int, typedefs: int,
+                     anonymous: int, if_nesting: int, seed: int) -> Dict[str, int]:
+    """Write a synthetic C project below root and return its statistics
+
+    Headers are arranged in include_depth layers, each header including two
+    headers of the next layer; every .c file includes two top-layer headers.
+    """
+    rnd = random.Random(seed)
+    src = root / "src"
+    src.mkdir(parents=True, exist_ok=True)
+
+    headers_per_layer = max(2, files // (2 * max(include_depth, 1)))
+    layer_types: Dict[int, List[str]] = {}
+    header_count = 0
+    total_bytes = 0
+
+    config_lines = ["#ifndef BENCH_CONFIG_H", "#define BENCH_CONFIG_H"]
+    for level in range(if_nesting):
+        config_lines.append(f"#define BENCH_LEVEL_{level} {level + 1}")
+    config_lines.append("#endif")
+    config_text = "\n".join(config_lines) + "\n"
+    (src / "bench_config.h").write_text(config_text, encoding="utf-8")
+    total_bytes += len(config_text)
+
+    for layer in reversed(range(include_depth)):
+        layer_types[layer] = []
+        for index in range(headers_per_layer):
+            name = _header_name(layer, index)
+            guard = name.upper().replace(".", "_")
+            prefix = f"l{layer}_{index}"
+            lines = [f"#ifndef {guard}", f"#define {guard}", '#include "bench_config.h"']
+            if layer + 1 < include_depth:
+                for child in rnd.sample(range(headers_per_layer), 2):
+                    lines.append(f'#include "{_header_name(layer + 1, child)}"')
+            known = layer_types.get(layer + 1, [])
+            body, names = _typedef_block(rnd, prefix, typedefs, anonymous, known)
+            body.append(f"#define {prefix.upper()}_LIMIT {rnd.randint(1, 1000)}")
+            body.append(f"int {prefix}_init({names[0] if names else 'int'} *ctx);")
+            body.append(f"extern int {prefix}_counter;")
+            lines.extend(_wrap_in_ifs(body, if_nesting, "BENCH_LEVEL"))
+            lines.append("#endif")
+            text = "\n".join(lines) + "\n"
+            (src / name).write_text(text, encoding="utf-8")
+            total_bytes += len(text)
+            layer_types[layer].extend(names)
+            header_count += 1
+
+    for index in range(files):
+        prefix = f"unit{index}"
+        lines = []
+        for child in rnd.sample(range(headers_per_layer), 2):
+            lines.append(f'#include "{_header_name(0, child)}"')
+        body, names = _typedef_block(rnd, prefix, max(1, typedefs // 2), anonymous, layer_types.get(0, []))
+        body.append(f"static int {prefix}_state = 0;")
+        body.append(f"int {prefix}_run(int value)")
+        body.append("{")
+        body.append(f"    return value + {prefix}_state;")
+        body.append("}")
+        lines.extend(_wrap_in_ifs(body, if_nesting, "BENCH_LEVEL"))
+        text = "\n".join(lines) + "\n"
+        (src / f"{prefix}.c").write_text(text, encoding="utf-8")
+        total_bytes += len(text)
+
+    return {"c_files": files, "headers": header_count + 1, "bytes": total_bytes}
+
+
+def benchmark_config(include_depth: int) -> Dict:
+    """Transformer configuration exercising includes, removals and renames"""
+    return {
+        "include_depth": include_depth,
+        "transformations_01_cleanup": {
+            "file_selection": [],
+            "remove": {"macros": ["_LIMIT$"], "typedef": ["_t1_t$"]},
+        },
+        "transformations_02_rename": {
+            "file_selection": [],
+            "rename": {"typedef": {"^(l\\d+_\\d+)_t2_t$": "\\1_renamed_t"}, "functions": {"_init$": "_setup"}},
+        },
+    }
+
+
+# ---------------------------------------------------------------------------
+# Stage runners
+# ---------------------------------------------------------------------------
+
+
+class Pipeline:
+    """Holds the intermediate results passed from one stage to the next"""
+
+    def __init__(self, project_root: Path, include_depth: int):
+        self.project_root = project_root
+        self.source_root = project_root / "src"
+        self.include_depth = include_depth
+        self.paths = sorted(self.source_root.iterdir())
+        self.contents = [path.read_text(encoding="utf-8") for path in self.paths]
+        self.tokens: List = []
+        self.files: Dict[str, FileModel] = {}
+        self.model_file = str(project_root / "model_transformed.json")
+        self.output_dir = str(project_root / "output")
+
+    def tokenize(self) -> int:
+        tokenizer = CTokenizer()
+        self.tokens = [tokenizer.tokenize(content) for content in self.contents]
+        return len(self.contents)
+
+    def filter(self) -> int:
+        for tokens in self.tokens:
+            PreprocessorEvaluator().filter_tokens(tokens)
+        return len(self.tokens)
+
+    def parse(self) -> int:
+        parser = CParser()
+        self.files = {}
+        for path in self.paths:
+            file_model = parser.parse_file(path, path.name)
+            self.files[file_model.name] = file_model
+        return len(self.paths)
+
+    def transform(self) -> int:
+        model = ProjectModel(
+            project_name="benchmark", source_folder=str(self.source_root), files=self.files
+        )
+        model.update_uses_fields()
+        transformer = Transformer()
+        model = transformer._apply_transformations(model, benchmark_config(self.include_depth))
+        model.save(self.model_file)
+        return len(model.files)
+
+    def generate(self) -> int:
+        Generator().generate(self.model_file, self.output_dir)
+        return sum(1 for path in self.paths if path.suffix == ".c")
+
+
+def run_stages(pipeline_factory: Callable[[], "Pipeline"], repeat: int, measure_memory: bool) -> Dict[str, Dict]:
+    """Time every stage (best of repeat) and optionally trace its peak memory"""
+    results: Dict[str, Dict] = {stage: {"seconds": None, "files": 0, "peak_kib": None} for stage in STAGES}
+
+    for _ in range(repeat):
+        pipeline = pipeline_factory()
+        for stage in STAGES:
+            gc.collect()
+            start = time.perf_counter()
+            count = getattr(pipeline, stage)()
+            elapsed = time.perf_counter() - start
+            entry = results[stage]
+            if entry["seconds"] is None or elapsed < entry["seconds"]:
+                entry["seconds"] = elapsed
+            entry["files"] = count
+
+    if measure_memory:
+        # Separate pass: tracing slows execution down too much to time it
+        pipeline = pipeline_factory()
+        for stage in STAGES:
+            gc.collect()
+            tracemalloc.start()
+            getattr(pipeline, stage)()
+            _, peak = tracemalloc.get_traced_memory()
+            tracemalloc.stop()
+            results[stage]["peak_kib"] = peak // 1024
+
+    for entry in results.values():
+        entry["files_per_second"] = entry["files"] / entry["seconds"] if entry["seconds"] else 0.0
+    return results
+
+
+# ---------------------------------------------------------------------------
+# Reporting and baseline comparison
+# ---------------------------------------------------------------------------
+
+
+def print_report(results: Dict, baseline: Dict = None, tolerance: float = 0.0) -> List[str]:
+    """Print the stage table and return the stages slower than the baseline"""
+    regressions = []
+    header = f"{'stage':<10} {'seconds':>9} {'files/s':>10} {'peak KiB':>10}"
+    if baseline:
+        header += f" {'baseline':>9} {'change':>8}"
+    print(header)
+    print("-" * len(header))
+    base_stages = (baseline or {}).get("stages", {})
+    for stage in STAGES:
+        entry = results["stages"][stage]
+        peak = "-" if entry["peak_kib"] is None else str(entry["peak_kib"])
+        line = f"{stage:<10} {entry['seconds']:>9.3f} {entry['files_per_second']:>10.1f} {peak:>10}"
+        base = base_stages.get(stage)
+        if base and base.get("seconds"):
+            change = entry["seconds"] / base["seconds"] - 1.0
+            marker = ""
+            if change > tolerance:
+                regressions.append(stage)
+                marker = " !"
+            line += f" {base['seconds']:>9.3f} {change:>+7.1%}{marker}"
+        print(line)
+    return regressions
+
+
+def load_json(path: str) -> Dict:
+    with open(path, "r", encoding="utf-8") as f:
+        return json.load(f)
+
+
+def save_json(path: str, data: Dict) -> None:
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump(data, f, indent=2)
+        f.write("\n")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Benchmark the parse/transform/generate pipeline on a synthetic C project")
+    parser.add_argument("--files", type=int, default=200, help="Number of .c files (default: 200)")
+    parser.add_argument("--include-depth", type=int, default=4, help="Number of header layers (default: 4)")
+    parser.add_argument("--typedefs", type=int, default=8, help="Typedefs per header (default: 8)")
+    parser.add_argument("--anonymous", type=int, default=1, help="Anonymous nested structs per struct (default: 1)")
+    parser.add_argument("--if-nesting", type=int, default=2, help="#if nesting depth around declarations (default: 2)")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed of the generated project (default: 1)")
+    parser.add_argument("--repeat", type=int, default=1, help="Runs per stage; the fastest is reported (default: 1)")
+    parser.add_argument("--no-memory", action="store_true", help="Skip the peak memory pass")
+    parser.add_argument("--workdir", help="Directory for the generated project (default: temporary directory)")
+    parser.add_argument("--keep", action="store_true", help="Keep the generated project and outputs")
+    parser.add_argument("--output", default=DEFAULT_OUTPUT, help="Results JSON file (default: artifacts/benchmark/results.json)")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="Baseline JSON to compare against (default: artifacts/benchmark/baseline.json)")
+    parser.add_argument("--save-baseline", action="store_true", help="Store these results as the new baseline")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="Allowed slowdown per stage before failing (default: 0.25)")
+    args = parser.parse_args()
+
+    import logging
+    logging.disable(logging.WARNING)
+
+    params = {
+        "files": args.files,
+        "include_depth": args.include_depth,
+        "typedefs": args.typedefs,
+        "anonymous": args.anonymous,
+        "if_nesting": args.if_nesting,
+        "seed": args.seed,
+    }
+
+    workdir = Path(args.workdir) if args.workdir else Path(tempfile.mkdtemp(prefix="c2puml_bench_"))
+    project_root = workdir / "project"
+    if project_root.exists():
+        shutil.rmtree(project_root)
+    try:
+        stats = generate_project(project_root, **params)
+        print(
+            f"Synthetic project: {stats['c_files']} .c files, {stats['headers']} headers, "
+            f"{stats['bytes'] / 1024:.0f} KiB in {project_root}"
+        )
+
+        def make_pipeline() -> Pipeline:
+            shutil.rmtree(project_root / "output", ignore_errors=True)
+            return Pipeline(project_root, args.include_depth)
+
+        stages = run_stages(make_pipeline, max(1, args.repeat), not args.no_memory)
+    finally:
+        if not args.keep and not args.workdir:
+            shutil.rmtree(workdir, ignore_errors=True)
+
+    results = {
+        "format": RESULT_FORMAT,
+        "version": __version__,
+        "python": platform.python_version(),
+        "params": params,
+        "project": stats,
+        "stages": stages,
+    }
+
+    baseline = None
+    if not args.save_baseline and os.path.exists(args.baseline):
+        baseline = load_json(args.baseline)
+        if baseline.get("params") != params:
+            print(f"Warning: baseline {args.baseline} was recorded with different parameters: {baseline.get('params')}")
+
+    regressions = print_report(results, baseline, args.tolerance)
+    save_json(args.output, results)
+    print(f"Results written to {args.output}")
+
+    if args.save_baseline:
+        save_json(args.baseline, results)
+        print(f"Baseline written to {args.baseline}")
+        return 0
+    if regressions:
+        print(f"Slower than baseline by more than {args.tolerance:.0%}: {', '.join(regressions)}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -211,9 +211,26 @@ if ! test_plantuml_setup "$PLANTUML_CMD"; then
     exit 1
 fi
 
-# Find all .puml files and convert them to PNG
-echo "📁 Scanning for .puml files in artifacts/output_example directory..."
-puml_files=$(find . -name "*.puml" -type f)
+# With an incremental output manifest, only convert changed diagrams (and any without a PNG yet)
+if [ -f "diagram_manifest.json" ] && command -v python3 &> /dev/null; then
+    echo "📋 Using diagram_manifest.json: converting changed diagrams only..."
+    puml_files=$(python3 -c '
+import json, os
+manifest = json.load(open("diagram_manifest.json", encoding="utf-8"))
+changed = set(manifest.get("changed", []))
+for name in sorted(manifest.get("diagrams", {})):
+    if name in changed or not os.path.exists(name[:-len(".puml")] + ".png"):
+        print("./" + name)
+')
+    if [ -z "$puml_files" ]; then
+        echo "ℹ️  No changed diagrams listed in diagram_manifest.json"
+        exit 0
+    fi
+else
+    # Find all .puml files and convert them to PNG
+    echo "📁 Scanning for .puml files in artifacts/output_example directory..."
+    puml_files=$(find . -name "*.puml" -type f)
+fi
 
 if [ -z "$puml_files" ]; then
     echo "ℹ️  No .puml files found in artifacts/output_example directory"
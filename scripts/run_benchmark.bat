@@ -0,0 +1,7 @@
+@echo off
+set SCRIPT_DIR=%~dp0
+cd /d %SCRIPT_DIR%..
+
+REM Run the pipeline benchmark; all arguments are forwarded (see --help)
+echo Running pipeline benchmark...
+python scripts/benchmark.py %*
@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+
+# Get script directory and change to project root
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+cd "$SCRIPT_DIR/.."
+
+# Run the pipeline benchmark; all arguments are forwarded (see --help)
+echo "Running pipeline benchmark..."
+python3 scripts/benchmark.py "$@"
@@ -28,6 +28,35 @@ class Config:
     always_show_includes: bool = False
     convert_empty_class_to_artifact: bool = False
 
+    # Parser execution options
+    jobs: int = 1  # Number of parser worker processes (0 or less means one per CPU)
+    parse_cache: bool = False  # Reuse parsed file models for unchanged files
+    parse_cache_dir: str = ""  # Parse cache location (empty means <output_dir>/.parse_cache)
+    tokenizer_engine: str = "line"  # Tokenizer engine: "line" or "single_pass"
+    anonymous_extraction: str = "text"  # Nested anonymous structures: "text" or "tokens"
+    deduplicate_anonymous: bool = False  # Store identical anonymous layouts once per project
+    preprocessor_mode: str = "project"  # #if evaluation: "project" or "translation_unit"
+    verify_mode: str = "full"  # Model verification: "full", "sample" or "off"
+    verify_sample_rate: float = 0.1  # Fraction of the files checked in "sample" verify mode
+    verify_max_issues: int = 0  # Stop verifying further files after this many issues (0 = no limit)
+    discovery_jobs: int = 1  # Number of threads walking the source folders (0 or less means one per CPU)
+    source_list: str = ""  # compile_commands.json or file manifest to take the sources from instead of walking
+    mmap_threshold: int = 0  # Read files of at least this many bytes through mmap (0 disables)
+    generate_jobs: int = 1  # Number of generator worker processes (0 or less means one per CPU)
+    incremental_output: bool = False  # Keep unchanged diagrams, delete orphans, write diagram_manifest.json
+    streaming_output: bool = False  # Stream each diagram to its file through a bounded buffer
+
+    # Render stage options (PNG images of the generated diagrams)
+    render_images: bool = False  # Render the diagrams at the end of the full workflow
+    render_jobs: int = 1  # Number of render workers (0 or less means one per CPU)
+    render_command: List[str] = field(default_factory=lambda: ["plantuml"])  # PlantUML command line
+    render_server: str = ""  # PlantUML server URL; when set, diagrams are posted to it instead
+
+    # Pipeline options
+    in_memory_pipeline: bool = False  # Pass models between steps in memory (full workflow only)
+    write_model_files: bool = True  # Write model.json/model_transformed.json in in-memory mode
+    model_format: str = "json"  # Model file format: "json" or "jsonl" (line-delimited, lazily loaded)
+
     # Generator formatting options
     max_function_signature_chars: int = 0  # 0 or less means unlimited (no truncation)
     hide_macro_values: bool = False  # Hide macro values in generated PlantUML diagrams
@@ -70,6 +99,52 @@ class Config:
             self.always_show_includes = False
         if not hasattr(self, "convert_empty_class_to_artifact"):
             self.convert_empty_class_to_artifact = False
+        if not hasattr(self, "jobs"):
+            self.jobs = 1
+        if not hasattr(self, "parse_cache"):
+            self.parse_cache = False
+        if not hasattr(self, "parse_cache_dir"):
+            self.parse_cache_dir = ""
+        if not hasattr(self, "tokenizer_engine"):
+            self.tokenizer_engine = "line"
+        if not hasattr(self, "anonymous_extraction"):
+            self.anonymous_extraction = "text"
+        if not hasattr(self, "deduplicate_anonymous"):
+            self.deduplicate_anonymous = False
+        if not hasattr(self, "preprocessor_mode"):
+            self.preprocessor_mode = "project"
+        if not hasattr(self, "verify_mode"):
+            self.verify_mode = "full"
+        if not hasattr(self, "verify_sample_rate"):
+            self.verify_sample_rate = 0.1
+        if not hasattr(self, "verify_max_issues"):
+            self.verify_max_issues = 0
+        if not hasattr(self, "discovery_jobs"):
+            self.discovery_jobs = 1
+        if not hasattr(self, "source_list"):
+            self.source_list = ""
+        if not hasattr(self, "mmap_threshold"):
+            self.mmap_threshold = 0
+        if not hasattr(self, "generate_jobs"):
+            self.generate_jobs = 1
+        if not hasattr(self, "incremental_output"):
+            self.incremental_output = False
+        if not hasattr(self, "streaming_output"):
+            self.streaming_output = False
+        if not hasattr(self, "render_images"):
+            self.render_images = False
+        if not hasattr(self, "render_jobs"):
+            self.render_jobs = 1
+        if not hasattr(self, "render_command"):
+            self.render_command = ["plantuml"]
+        if not hasattr(self, "render_server"):
+            self.render_server = ""
+        if not hasattr(self, "in_memory_pipeline"):
+            self.in_memory_pipeline = False
+        if not hasattr(self, "write_model_files"):
+            self.write_model_files = True
+        if not hasattr(self, "model_format"):
+            self.model_format = "json"
         if not hasattr(self, "max_function_signature_chars"):
             self.max_function_signature_chars = 0
         if not hasattr(self, "hide_macro_values"):
@@ -182,6 +257,29 @@ class Config:
             "include_filter_local_only": self.include_filter_local_only,
             "always_show_includes": self.always_show_includes,
             "convert_empty_class_to_artifact": self.convert_empty_class_to_artifact,
+            "jobs": self.jobs,
+            "parse_cache": self.parse_cache,
+            "parse_cache_dir": self.parse_cache_dir,
+            "tokenizer_engine": self.tokenizer_engine,
+            "anonymous_extraction": self.anonymous_extraction,
+            "deduplicate_anonymous": self.deduplicate_anonymous,
+            "preprocessor_mode": self.preprocessor_mode,
+            "verify_mode": self.verify_mode,
+            "verify_sample_rate": self.verify_sample_rate,
+            "verify_max_issues": self.verify_max_issues,
+            "discovery_jobs": self.discovery_jobs,
+            "source_list": self.source_list,
+            "mmap_threshold": self.mmap_threshold,
+            "generate_jobs": self.generate_jobs,
+            "incremental_output": self.incremental_output,
+            "streaming_output": self.streaming_output,
+            "render_images": self.render_images,
+            "render_jobs": self.render_jobs,
+            "render_command": self.render_command,
+            "render_server": self.render_server,
+            "in_memory_pipeline": self.in_memory_pipeline,
+            "write_model_files": self.write_model_files,
+            "model_format": self.model_format,
             "max_function_signature_chars": self.max_function_signature_chars,
             "hide_macro_values": self.hide_macro_values,
             "file_filters": self.file_filters,
@@ -243,6 +341,29 @@ class Config:
             and self.include_filter_local_only == other.include_filter_local_only
             and self.always_show_includes == other.always_show_includes
             and self.convert_empty_class_to_artifact == other.convert_empty_class_to_artifact
+            and self.jobs == other.jobs
+            and self.parse_cache == other.parse_cache
+            and self.parse_cache_dir == other.parse_cache_dir
+            and self.tokenizer_engine == other.tokenizer_engine
+            and self.anonymous_extraction == other.anonymous_extraction
+            and self.deduplicate_anonymous == other.deduplicate_anonymous
+            and self.preprocessor_mode == other.preprocessor_mode
+            and self.verify_mode == other.verify_mode
+            and self.verify_sample_rate == other.verify_sample_rate
+            and self.verify_max_issues == other.verify_max_issues
+            and self.discovery_jobs == other.discovery_jobs
+            and self.source_list == other.source_list
+            and self.mmap_threshold == other.mmap_threshold
+            and self.generate_jobs == other.generate_jobs
+            and self.incremental_output == other.incremental_output
+            and self.streaming_output == other.streaming_output
+            and self.render_images == other.render_images
+            and self.render_jobs == other.render_jobs
+            and self.render_command == other.render_command
+            and self.render_server == other.render_server
+            and self.in_memory_pipeline == other.in_memory_pipeline
+            and self.write_model_files == other.write_model_files
+            and self.model_format == other.model_format
             and self.hide_macro_values == other.hide_macro_values
             and self.file_filters == other.file_filters
             and self.file_specific == other.file_specific
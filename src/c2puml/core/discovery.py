@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""
+Source file discovery for the parser.
+
+SourceDiscovery finds the C/C++ files of a source folder in a single
+os.scandir walk. Hidden and excluded directories are pruned before they are
+entered, extensions and the file name filter are matched while walking, and
+file types come from the directory entries instead of extra stat calls. The
+top-level subtrees can be walked by several threads; the result is sorted,
+so it does not depend on the number of threads.
+
+Instead of walking, the files can be read from a compile_commands.json
+compilation database or a manifest (a JSON list of paths or a text file with
+one path per line). A compilation database lists translation units only, so
+the headers next to them and in their include directories are added.
+"""
+
+import json
+import logging
+import os
+import shlex
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from typing import Callable, Iterable, List, Optional, Set, Tuple
+
+from .preprocessor import HEADER_EXTENSIONS
+
+C_EXTENSIONS = (".c", ".h", ".cpp", ".cc", ".cxx", ".hpp", ".hxx")
+
+# Directories that never hold project sources (hidden directories are skipped as well)
+EXCLUDED_DIRS = frozenset({".git", "__pycache__", "node_modules", ".vscode", ".idea"})
+
+# Compiler options naming an include directory, as a separate or attached argument
+_INCLUDE_OPTIONS = ("-I", "-iquote", "-isystem", "-idirafter")
+
+
+def _is_pruned(name: str) -> bool:
+    return name.startswith(".") or name in EXCLUDED_DIRS
+
+
+class SourceDiscovery:
+    """Finds the C/C++ files of a source folder
+
+    name_filter receives a file name and returns whether the file is kept
+    (Config._should_include_file); matched counts the files with a C/C++
+    extension of the last call before the filter was applied.
+    """
+
+    def __init__(
+        self,
+        jobs: int = 1,
+        source_list: str = "",
+        name_filter: Optional[Callable[[str], bool]] = None,
+    ):
+        self.jobs = jobs
+        self.source_list = source_list
+        self.name_filter = name_filter
+        self.matched = 0
+        self.logger = logging.getLogger(__name__)
+
+    @classmethod
+    def from_config(cls, config) -> "SourceDiscovery":
+        """Create a discovery from the discovery options and file filters of a Config"""
+        return cls(
+            jobs=getattr(config, "discovery_jobs", 1),
+            source_list=getattr(config, "source_list", ""),
+            name_filter=config._should_include_file,
+        )
+
+    def find(self, root: Path, recursive: bool = True) -> List[Path]:
+        """Return the sorted C/C++ files of root that pass the name filter"""
+        if self.source_list:
+            candidates = self._listed_files(root, recursive)
+        else:
+            candidates = self._walk(root, recursive)
+
+        self.matched = len(candidates)
+        if self.name_filter is None:
+            files = candidates
+        else:
+            files = []
+            for path in candidates:
+                if self.name_filter(path.name):
+                    files.append(path)
+                else:
+                    self.logger.debug("Excluded file after filtering: %s", path.name)
+        self.logger.debug("Found %d C/C++ files in %s", len(files), root)
+        return sorted(files)
+
+    def _walk(self, root: Path, recursive: bool) -> List[Path]:
+        """Walk root once, walking its top-level subdirectories in parallel"""
+        try:
+            files, subdirs = self._scan_directory(str(root), recursive)
+        except OSError as e:
+            raise OSError(f"Failed to search for C/C++ files in '{root}': {e}")
+        if not subdirs:
+            return files
+
+        jobs = self._resolve_jobs(self.jobs)
+        if jobs > 1 and len(subdirs) > 1:
+            with ThreadPoolExecutor(max_workers=min(jobs, len(subdirs))) as executor:
+                for subtree in executor.map(self._walk_subtree, subdirs):
+                    files.extend(subtree)
+        else:
+            for subdir in subdirs:
+                files.extend(self._walk_subtree(subdir))
+        return files
+
+    def _walk_subtree(self, top: str) -> List[Path]:
+        files: List[Path] = []
+        pending = [top]
+        while pending:
+            directory = pending.pop()
+            try:
+                found, subdirs = self._scan_directory(directory, True)
+            except OSError as e:
+                self.logger.warning("Error during recursive search in %s: %s", directory, e)
+                continue
+            files.extend(found)
+            pending.extend(subdirs)
+        return files
+
+    @staticmethod
+    def _scan_directory(directory: str, recursive: bool) -> Tuple[List[Path], List[str]]:
+        """Return the C/C++ files and the subdirectories to descend into of one directory
+
+        Symbolic links to directories are not followed; symbolic links to
+        files are kept like regular files.
+        """
+        files: List[Path] = []
+        subdirs: List[str] = []
+        with os.scandir(directory) as entries:
+            for entry in entries:
+                name = entry.name
+                if _is_pruned(name):
+                    continue
+                try:
+                    if entry.is_dir(follow_symlinks=False):
+                        if recursive:
+                            subdirs.append(entry.path)
+                    elif name.endswith(C_EXTENSIONS) and entry.is_file():
+                        files.append(Path(entry.path))
+                except OSError:
+                    continue
+        return files, subdirs
+
+    def _listed_files(self, root: Path, recursive: bool) -> List[Path]:
+        """Return the files of the source list that lie in root"""
+        try:
+            sources, include_dirs = self._read_source_list(self.source_list)
+        except (OSError, ValueError) as e:
+            raise OSError(f"Failed to read source list '{self.source_list}': {e}")
+
+        root_text = str(root)
+        files: Set[str] = set()
+
+        def in_root(path: str) -> bool:
+            if recursive:
+                if not path.startswith(root_text + os.sep):
+                    return False
+                parts = path[len(root_text) + 1:].split(os.sep)
+            else:
+                if os.path.dirname(path) != root_text:
+                    return False
+                parts = [os.path.basename(path)]
+            return not any(_is_pruned(part) for part in parts)
+
+        for path in sources:
+            if path.endswith(C_EXTENSIONS) and in_root(path) and os.path.isfile(path):
+                files.add(path)
+
+        if include_dirs is not None:
+            # Headers of the translation units: next to them and in their include directories
+            directories = {os.path.dirname(path) for path in files} | set(include_dirs)
+            for directory in sorted(directories):
+                try:
+                    found, _ = self._scan_directory(directory, False)
+                except OSError:
+                    continue
+                for path in found:
+                    text = str(path)
+                    if text.endswith(HEADER_EXTENSIONS) and in_root(text):
+                        files.add(text)
+
+        self.logger.debug(
+            "Source list %s: %d C/C++ files in %s", self.source_list, len(files), root
+        )
+        return [Path(path) for path in files]
+
+    @staticmethod
+    def _read_source_list(source_list: str) -> Tuple[List[str], Optional[List[str]]]:
+        """Read the absolute file paths (and include directories) of a source list
+
+        Returns (paths, include directories); the include directories are None
+        for a manifest, whose files are taken as listed.
+        """
+        base = os.path.dirname(os.path.abspath(source_list))
+        with open(source_list, "r", encoding="utf-8") as f:
+            text = f.read()
+        try:
+            data = json.loads(text)
+        except ValueError:
+            data = None
+
+        if isinstance(data, list) and all(isinstance(entry, dict) for entry in data):
+            sources, include_dirs = [], []
+            for entry in data:
+                if "file" not in entry:
+                    raise ValueError("compilation database entry without 'file'")
+                directory = os.path.join(base, entry.get("directory", ""))
+                sources.append(os.path.normpath(os.path.join(directory, entry["file"])))
+                include_dirs.extend(
+                    os.path.normpath(os.path.join(directory, include_dir))
+                    for include_dir in SourceDiscovery._include_dirs(entry)
+                )
+            return sources, include_dirs
+
+        if isinstance(data, list):
+            paths: Iterable = data
+        elif data is None:
+            paths = (line.strip() for line in text.splitlines())
+            paths = [line for line in paths if line and not line.startswith("#")]
+        else:
+            raise ValueError("expected a compilation database, a JSON list or one path per line")
+        return [os.path.normpath(os.path.join(base, str(path))) for path in paths], None
+
+    @staticmethod
+    def _include_dirs(entry: dict) -> List[str]:
+        """Return the include directories of a compilation database entry"""
+        arguments = entry.get("arguments")
+        if arguments is None:
+            arguments = shlex.split(entry.get("command", ""))
+        include_dirs = []
+        arguments = list(arguments)
+        for index, argument in enumerate(arguments):
+            for option in _INCLUDE_OPTIONS:
+                if argument == option:
+                    if index + 1 < len(arguments):
+                        include_dirs.append(arguments[index + 1])
+                    break
+                if argument.startswith(option) and len(argument) > len(option):
+                    include_dirs.append(argument[len(option):])
+                    break
+        return include_dirs
+
+    @staticmethod
+    def _resolve_jobs(jobs) -> int:
+        """Return the effective number of walker threads"""
+        try:
+            jobs = int(jobs)
+        except (TypeError, ValueError):
+            return 1
+        return jobs if jobs > 0 else (os.cpu_count() or 1)
@@ -5,13 +5,19 @@ Follows the template format with strict separation of typedefs and clear relatio
 """
 
 import glob
+import hashlib
+import json
+import logging
 import os
 import re
+from concurrent.futures import ProcessPoolExecutor
 from pathlib import Path
-from typing import Dict, List, Optional
+from typing import Dict, List, Optional, Set, Tuple
 
 from ..models import Field, FileModel, Function, ProjectModel
 from .parse_utils import normalize_type_and_name_for_arrays
+from .profiler import PROFILER
+from .symbol_index import ProjectSymbolIndex
 
 # PlantUML generation constants
 MAX_LINE_LENGTH = 120
@@ -27,6 +33,116 @@ COLOR_TYPEDEF = "#LightYellow"
 PREFIX_HEADER = "HEADER_"
 PREFIX_TYPEDEF = "TYPEDEF_"
 
+# Generated output files and the manifest of the incremental output mode
+OUTPUT_PATTERNS = ("*.puml", "*.png", "*.html")
+DIAGRAM_MANIFEST = "diagram_manifest.json"
+DIAGRAM_MANIFEST_FORMAT = "c2puml-diagram-manifest"
+DIAGRAM_MANIFEST_VERSION = 1
+
+# Streaming output mode: lines held back before a flush and the file buffer size
+STREAM_FLUSH_LINES = 4096
+STREAM_BUFFER_BYTES = 1 << 16
+
+# Per-process generator state used by the generation worker pool
+_WORKER_GENERATOR = None
+_WORKER_MODEL = None
+
+
+def _init_generate_worker(
+    project_model: "ProjectModel",
+    settings: Dict[str, object],
+    profile_memory: Optional[bool] = None,
+):
+    """Create the generator instance and shared model reused by a worker process
+
+    profile_memory is None unless the main process profiles the run.
+    """
+    global _WORKER_GENERATOR, _WORKER_MODEL
+    if profile_memory is not None:
+        PROFILER.start(trace_memory=profile_memory)
+    # Class level configuration is not inherited by spawned processes
+    for name, value in settings.items():
+        setattr(Generator, name, value)
+    _WORKER_GENERATOR = Generator()
+    _WORKER_MODEL = project_model
+
+
+def _generate_file_worker(file_key: str, output_file: str):
+    """Render and write the diagram of one root file in a worker process
+
+    Returns the _write_diagram result and the worker's profile snapshot.
+    """
+    result = _WORKER_GENERATOR._write_diagram(
+        _WORKER_MODEL.files[file_key], _WORKER_MODEL, output_file
+    )
+    return result, PROFILER.drain()
+
+
+class DiagramSink:
+    """Line sink that streams a diagram to a text file as it is generated
+
+    The emitters only append and extend lines, pop the newest line and
+    replace the last one, so every line but the newest few is flushed once
+    STREAM_FLUSH_LINES are pending. The file receives exactly the text
+    "\\n".join(lines) of the equivalent in-memory diagram.
+    """
+
+    # Lines kept pending at a flush so pop() and [-1] keep working
+    KEEP_LINES = 2
+
+    def __init__(self, stream, digest=None, flush_lines: int = STREAM_FLUSH_LINES):
+        self._stream = stream
+        self._digest = digest
+        self._flush_lines = max(flush_lines, self.KEEP_LINES + 1)
+        self._pending: List[str] = []
+        self._started = False
+
+    def append(self, line: str) -> None:
+        self._pending.append(line)
+        if len(self._pending) >= self._flush_lines:
+            self._flush(len(self._pending) - self.KEEP_LINES)
+
+    def extend(self, lines) -> None:
+        for line in lines:
+            self.append(line)
+
+    def pop(self) -> str:
+        return self._pending.pop()
+
+    def __getitem__(self, index: int) -> str:
+        return self._pending[index]
+
+    def __setitem__(self, index: int, line: str) -> None:
+        self._pending[index] = line
+
+    def close(self) -> None:
+        """Flush all pending lines"""
+        self._flush(len(self._pending))
+
+    def _flush(self, count: int) -> None:
+        if count <= 0:
+            return
+        chunk = "\n".join(self._pending[:count])
+        if self._started:
+            chunk = "\n" + chunk
+        del self._pending[:count]
+        self._started = True
+        self._stream.write(chunk)
+        if self._digest is not None:
+            self._digest.update(chunk.encode("utf-8"))
+
+
+def _file_sha256(path: str) -> Optional[str]:
+    """Return the SHA-256 of a text file's content, or None if it cannot be read"""
+    digest = hashlib.sha256()
+    try:
+        with open(path, "r", encoding="utf-8") as f:
+            for chunk in iter(lambda: f.read(STREAM_BUFFER_BYTES), ""):
+                digest.update(chunk.encode("utf-8"))
+    except (OSError, UnicodeDecodeError):
+        return None
+    return digest.hexdigest()
+
 
 class Generator:
     """Generator that creates proper PlantUML files.
@@ -44,6 +160,18 @@ class Generator:
     max_function_signature_chars: int = 0  # 0 or less = unlimited
     hide_macro_values: bool = False  # Hide macro values in generated PlantUML diagrams
     convert_empty_class_to_artifact: bool = False  # Render empty headers as artifacts when enabled
+    jobs: int = 1  # Number of generation worker processes (0 or less = one per CPU)
+    incremental_output: bool = False  # Rewrite only changed diagrams and write a manifest
+    streaming_output: bool = False  # Stream diagrams to their files instead of building them in memory
+
+    def __init__(self):
+        # Rendered header fragments shared by all diagrams of a model:
+        # (kind, file key) -> (FileModel rendered, variant, lines)
+        self._fragments: Dict[Tuple[str, str], Tuple[FileModel, tuple, Tuple[str, ...]]] = {}
+        self._fragment_hits = 0
+        self._fragment_renders = 0
+        # Model keys of the root files to draw (None: all); set for sharded runs
+        self.root_files: Optional[Set[str]] = None
 
     def _clear_output_folder(self, output_dir: str) -> None:
         """Clear existing .puml and .png files from the output directory"""
@@ -51,7 +179,7 @@ class Generator:
             return
 
         # Remove files with specified extensions in the output directory
-        for ext in ("*.puml", "*.png", "*.html"):
+        for ext in OUTPUT_PATTERNS + (DIAGRAM_MANIFEST,):
             for file_path in glob.glob(os.path.join(output_dir, ext)):
                 try:
                     os.remove(file_path)
@@ -64,62 +192,260 @@ class Generator:
         """Generate PlantUML files for all C files in the model"""
         # Load the model
         project_model = self._load_model(model_file)
+        return self.generate_from_model(project_model, output_dir)
 
+    @PROFILER.profiled("generate")
+    def generate_from_model(
+        self, project_model: ProjectModel, output_dir: str = "./output"
+    ) -> str:
+        """Generate PlantUML files for all C files of an in-memory project model"""
         # Create output directory
         os.makedirs(output_dir, exist_ok=True)
 
-        # Clear existing .puml and .png files from output directory
-        self._clear_output_folder(output_dir)
+        # Clear existing .puml and .png files from output directory, unless only
+        # changed diagrams are to be rewritten
+        if not self.incremental_output:
+            self._clear_output_folder(output_dir)
+
+        # include_depth is handled by the transformer which processes
+        # file-specific settings and stores them in include_relations
+        tasks = self._collect_diagram_tasks(project_model, output_dir)
+
+        # Render with a worker pool when configured; output is identical to serial mode
+        results = None
+        jobs = self._resolve_jobs(self.jobs)
+        if jobs > 1:
+            results = self._generate_parallel(project_model, tasks, jobs)
+        if results is None:
+            # Generate a PlantUML file for each C file
+            results = [
+                self._write_diagram(project_model.files[filename], project_model, output_file)
+                for output_file, filename in tasks.items()
+            ]
+
+        if self.incremental_output:
+            self._finish_incremental_output(output_dir, results)
+
+        if self._fragment_renders:
+            logging.getLogger(__name__).info(
+                "Header fragment cache: %d rendered, %d reused",
+                self._fragment_renders,
+                self._fragment_hits,
+            )
+            self._fragment_hits = self._fragment_renders = 0
+
+        return output_dir
 
-        # Generate a PlantUML file for each C file
-        generated_files = []
+    def _collect_diagram_tasks(
+        self, project_model: ProjectModel, output_dir: str
+    ) -> Dict[str, str]:
+        """Map each output .puml path to the model key of the root C file it shows
 
+        Roots that map to the same .puml name resolve to the last one in sorted
+        order, which is the diagram a sequential overwrite would leave behind.
+        """
+        tasks: Dict[str, str] = {}
         for filename, file_model in sorted(project_model.files.items()):
             # Only process C files (not headers) for diagram generation
             if file_model.name.endswith(".c"):
-                # Generate PlantUML content
-                # include_depth is handled by the transformer which processes
-                # file-specific settings and stores them in include_relations
-                puml_content = self.generate_diagram(
-                    file_model, project_model
-                )
+                if self.root_files is not None and filename not in self.root_files:
+                    continue
+                output_file = self._output_file_for(file_model, output_dir)
+                tasks.pop(output_file, None)
+                tasks[output_file] = filename
+        return tasks
+
+    @staticmethod
+    def _output_file_for(file_model: FileModel, output_dir: str) -> str:
+        """Return the .puml path written for a root C file"""
+        basename = Path(file_model.name).stem
+        return os.path.join(output_dir, f"{basename}.puml")
 
-                # Create output filename
-                basename = Path(file_model.name).stem
-                output_file = os.path.join(output_dir, f"{basename}.puml")
+    def _write_diagram(
+        self, file_model: FileModel, project_model: ProjectModel, output_file: str
+    ) -> Tuple[str, Optional[str], bool]:
+        """Generate the diagram of a root C file and write it to output_file
 
-                # Write the file
-                with open(output_file, "w", encoding="utf-8") as f:
-                    f.write(puml_content)
+        Returns (output_file, content_hash, written). In incremental mode the
+        file is left untouched when its content is already identical; the hash
+        is only computed in that mode.
+        """
+        if self.streaming_output:
+            with PROFILER.stage("generate.diagram", item=os.path.basename(output_file)):
+                return self._stream_diagram(file_model, project_model, output_file)
 
-                generated_files.append(output_file)
+        with PROFILER.stage("generate.diagram", item=os.path.basename(output_file)):
+            puml_content = self.generate_diagram(file_model, project_model)
 
-        return output_dir
+        content_hash = None
+        if self.incremental_output:
+            content_hash = hashlib.sha256(puml_content.encode("utf-8")).hexdigest()
+            try:
+                with open(output_file, "r", encoding="utf-8") as f:
+                    if f.read() == puml_content:
+                        return output_file, content_hash, False
+            except (OSError, UnicodeDecodeError):
+                pass  # Missing or unreadable output is simply rewritten
+
+        with open(output_file, "w", encoding="utf-8") as f:
+            f.write(puml_content)
+        return output_file, content_hash, True
+
+    def _stream_diagram(
+        self, file_model: FileModel, project_model: ProjectModel, output_file: str
+    ) -> Tuple[str, Optional[str], bool]:
+        """Generate a diagram straight into output_file through a DiagramSink
+
+        In incremental mode the diagram is streamed to a temporary file next
+        to the output, which replaces the output only when the hashes differ.
+        """
+        digest = hashlib.sha256() if self.incremental_output else None
+        target = output_file + ".tmp" if digest is not None else output_file
+        try:
+            with open(target, "w", encoding="utf-8", buffering=STREAM_BUFFER_BYTES) as f:
+                sink = DiagramSink(f, digest)
+                self._emit_diagram(sink, file_model, project_model)
+                sink.close()
+        except BaseException:
+            if target != output_file and os.path.exists(target):
+                os.remove(target)
+            raise
+
+        if digest is None:
+            return output_file, None, True
+        content_hash = digest.hexdigest()
+        if _file_sha256(output_file) == content_hash:
+            os.remove(target)
+            return output_file, content_hash, False
+        os.replace(target, output_file)
+        return output_file, content_hash, True
+
+    def _finish_incremental_output(
+        self, output_dir: str, results: List[Tuple[str, Optional[str], bool]]
+    ) -> None:
+        """Delete orphaned outputs and write the manifest of changed diagrams"""
+        diagrams = {os.path.basename(path): digest for path, digest, _ in results}
+        changed = sorted(os.path.basename(path) for path, _, written in results if written)
+        current_stems = {Path(name).stem for name in diagrams}
+
+        # Outputs (and rendered images) of diagrams that no longer exist
+        removed = []
+        for ext in OUTPUT_PATTERNS:
+            for file_path in glob.glob(os.path.join(output_dir, ext)):
+                if Path(file_path).stem in current_stems:
+                    continue
+                try:
+                    os.remove(file_path)
+                except OSError:
+                    continue  # Ignore errors if file can't be removed
+                if file_path.endswith(".puml"):
+                    removed.append(os.path.basename(file_path))
+
+        manifest = {
+            "format": DIAGRAM_MANIFEST_FORMAT,
+            "version": DIAGRAM_MANIFEST_VERSION,
+            "diagrams": dict(sorted(diagrams.items())),
+            "changed": changed,
+            "removed": sorted(removed),
+        }
+        with open(os.path.join(output_dir, DIAGRAM_MANIFEST), "w", encoding="utf-8") as f:
+            json.dump(manifest, f, indent=2)
+
+        logging.getLogger(__name__).info(
+            "Incremental output: %d changed, %d unchanged, %d removed",
+            len(changed),
+            len(diagrams) - len(changed),
+            len(removed),
+        )
+
+    @staticmethod
+    def _resolve_jobs(jobs) -> int:
+        """Return the effective number of generation worker processes"""
+        try:
+            jobs = int(jobs)
+        except (TypeError, ValueError):
+            logging.getLogger(__name__).warning(
+                "Invalid generate jobs value '%s', generating serially", jobs
+            )
+            return 1
+        if jobs <= 0:
+            return os.cpu_count() or 1
+        return jobs
+
+    def _generate_parallel(
+        self, project_model: ProjectModel, tasks: Dict[str, str], jobs: int
+    ) -> Optional[List[Tuple[str, Optional[str], bool]]]:
+        """Render diagrams with a worker pool, or return None if no pool is available
+
+        Each worker renders and writes whole diagrams; tasks map distinct
+        output files to root keys, so no two workers write the same file.
+        """
+        if len(tasks) < 2:
+            return None
+
+        settings = {
+            "max_function_signature_chars": self.max_function_signature_chars,
+            "hide_macro_values": self.hide_macro_values,
+            "convert_empty_class_to_artifact": self.convert_empty_class_to_artifact,
+            "incremental_output": self.incremental_output,
+            "streaming_output": self.streaming_output,
+        }
+        logger = logging.getLogger(__name__)
+        profile_memory = PROFILER.trace_memory if PROFILER.enabled else None
+        try:
+            executor = ProcessPoolExecutor(
+                max_workers=min(jobs, len(tasks)),
+                initializer=_init_generate_worker,
+                initargs=(project_model, settings, profile_memory),
+            )
+        except (OSError, NotImplementedError) as e:
+            logger.warning("Parallel generation unavailable (%s), generating serially", e)
+            return None
+
+        logger.info("Generating diagrams with %d worker processes", min(jobs, len(tasks)))
+        chunksize = max(1, len(tasks) // (jobs * 4))
+        results = []
+        with executor:
+            for result, profile in executor.map(
+                _generate_file_worker,
+                list(tasks.values()),
+                list(tasks.keys()),
+                chunksize=chunksize,
+            ):
+                PROFILER.merge(profile)
+                results.append(result)
+        return results
 
     def generate_diagram(
         self, file_model: FileModel, project_model: ProjectModel
     ) -> str:
         """Generate a PlantUML diagram for a file following the template format"""
+        lines: List[str] = []
+        self._emit_diagram(lines, file_model, project_model)
+        return "\n".join(lines)
+
+    def _emit_diagram(
+        self, lines, file_model: FileModel, project_model: ProjectModel
+    ) -> None:
+        """Append the diagram lines of a file to lines (a list or DiagramSink)"""
         basename = Path(file_model.name).stem
         # Capture placeholder headers for this diagram (if provided by transformer)
         self._placeholder_headers = set(getattr(file_model, "placeholder_headers", set()))
         include_tree = self._build_include_tree(
             file_model, project_model
         )
-        # Precompute header-declared names for visibility
-        header_function_decl_names: set[str] = set()
-        header_global_names: set[str] = set()
-        for filename, fm in project_model.files.items():
-            if filename.endswith(".h"):
-                for f in fm.functions:
-                    if f.is_declaration:
-                        header_function_decl_names.add(f.name)
-                for g in fm.globals:
-                    header_global_names.add(g.name)
+        # Anonymous structures the tree refers to but other files store (deduplicate_anonymous)
+        self._shared_anonymous, _owner_keys = self._collect_shared_anonymous(
+            include_tree, project_model
+        )
+        # Header-declared names for visibility are shared by all diagrams of the model
+        symbol_index = ProjectSymbolIndex.for_model(project_model)
+        header_function_decl_names = symbol_index.header_function_decl_names
+        header_global_names = symbol_index.header_global_names
 
         uml_ids = self._generate_uml_ids(include_tree, project_model)
 
-        lines = [f"@startuml {basename}", ""]
+        lines.extend([f"@startuml {basename}", ""])
 
         self._generate_all_file_classes(
             lines,
@@ -132,7 +458,6 @@ class Generator:
         self._generate_relationships(lines, include_tree, uml_ids, project_model)
 
         lines.extend(["", "@enduml"])
-        return "\n".join(lines)
 
     def _generate_all_file_classes(
         self,
@@ -215,9 +540,45 @@ class Generator:
             # Skip typedef class generation for placeholder headers
             if file_path.endswith(".h") and file_path in getattr(self, "_placeholder_headers", set()):
                 continue
-            self._generate_typedef_classes(
+            if not file_path.endswith(".h"):
+                self._generate_typedef_classes(
+                    lines,
+                    file_data,
+                    uml_ids,
+                    suppressed_structs,
+                    suppressed_unions,
+                    funcptr_alias_names,
+                )
+                continue
+            # Typedef UML ids derive from the names alone, so a header's classes
+            # only vary with the struct names this diagram suppresses
+            hidden = tuple(
+                sorted(
+                    name
+                    for name in file_data.structs
+                    if name in funcptr_alias_names or name in suppressed_structs
+                )
+            ) + tuple(sorted(name for name in file_data.unions if name in suppressed_unions))
+            self._cached_fragment(
                 lines,
+                "typedefs",
+                file_path,
                 file_data,
+                hidden,
+                lambda fragment: self._generate_typedef_classes(
+                    fragment,
+                    file_data,
+                    uml_ids,
+                    suppressed_structs,
+                    suppressed_unions,
+                    funcptr_alias_names,
+                ),
+            )
+        shared = getattr(self, "_shared_anonymous", None)
+        if shared is not None and (shared.structs or shared.unions):
+            self._generate_typedef_classes(
+                lines,
+                shared,
                 uml_ids,
                 suppressed_structs,
                 suppressed_unions,
@@ -225,6 +586,33 @@ class Generator:
             )
         lines.append("")
 
+    def _cached_fragment(
+        self,
+        lines,
+        kind: str,
+        file_key: str,
+        file_model: FileModel,
+        variant: tuple,
+        render,
+    ) -> None:
+        """Append a header fragment, rendering it only once per FileModel and variant
+
+        render(fragment) appends the lines to a fresh list. An entry is reused
+        only for the identical FileModel object, so a new model (for instance
+        in a watch session) renders again; variant holds the settings and
+        diagram-dependent inputs the fragment depends on.
+        """
+        entry = self._fragments.get((kind, file_key))
+        if entry is not None and entry[0] is file_model and entry[1] == variant:
+            self._fragment_hits += 1
+            lines.extend(entry[2])
+            return
+        fragment: List[str] = []
+        render(fragment)
+        self._fragment_renders += 1
+        self._fragments[(kind, file_key)] = (file_model, variant, tuple(fragment))
+        lines.extend(fragment)
+
     def _load_model(self, model_file: str) -> ProjectModel:
         """Load the project model from JSON file"""
         return ProjectModel.load(model_file)
@@ -234,20 +622,8 @@ class Generator:
     ) -> Dict[str, FileModel]:
         """Build include tree starting from root file"""
         include_tree = {}
-
-        def find_file_key(file_name: str) -> str:
-            """Find the correct key for a file in project_model.files using filename matching"""
-            # First try exact match
-            if file_name in project_model.files:
-                return file_name
-
-            # Try matching by filename (filenames are guaranteed to be unique)
-            filename = Path(file_name).name
-            if filename in project_model.files:
-                return filename
-
-            # If not found, return the filename (will be handled gracefully)
-            return filename
+        # Exact key, else filename (filenames are guaranteed to be unique keys)
+        find_file_key = ProjectSymbolIndex.for_model(project_model).find_file_key
 
         # Start with the root file
         root_key = find_file_key(root_file.name)
@@ -288,6 +664,48 @@ class Generator:
 
         return include_tree
 
+    def _collect_shared_anonymous(
+        self, include_tree: Dict[str, FileModel], project_model: ProjectModel
+    ) -> Tuple[FileModel, set]:
+        """Collect anonymous structures referenced from the tree but stored outside it
+
+        With deduplicate_anonymous an anonymous layout is kept only by the first
+        file defining it, so diagrams of other files show the owner's entity
+        (and the entities nested in it). Returns them as one FileModel together
+        with the keys of their owning files.
+        """
+        shared = FileModel(file_path="", name="shared_anonymous")
+        owner_keys = set()
+        defined = set()
+        pending = []
+        for file_model in include_tree.values():
+            defined.update(file_model.structs)
+            defined.update(file_model.unions)
+            for children in file_model.anonymous_relationships.values():
+                pending.extend(children)
+        if all(child in defined for child in pending):
+            return shared, owner_keys
+
+        symbol_index = ProjectSymbolIndex.for_model(project_model)
+        while pending:
+            name = pending.pop()
+            if name in defined:
+                continue
+            defined.add(name)
+            owner_key = symbol_index.typedef_owner(name)
+            if owner_key is None:
+                continue
+            owner = project_model.files[owner_key]
+            if name in owner.structs:
+                shared.structs[name] = owner.structs[name]
+            elif name in owner.unions:
+                shared.unions[name] = owner.unions[name]
+            else:
+                continue
+            owner_keys.add(owner_key)
+            pending.extend(owner.anonymous_relationships.get(name, ()))
+        return shared, owner_keys
+
     def _generate_uml_ids(
         self, include_tree: Dict[str, FileModel], project_model: ProjectModel
     ) -> Dict[str, str]:
@@ -327,6 +745,13 @@ class Generator:
                     f"{PREFIX_TYPEDEF}{typedef_name.upper()}"
                 )
 
+        shared = getattr(self, "_shared_anonymous", None)
+        if shared is not None:
+            for typedef_name in list(shared.structs) + list(shared.unions):
+                uml_ids[f"typedef_{typedef_name}"] = (
+                    f"{PREFIX_TYPEDEF}{typedef_name.upper()}"
+                )
+
         return uml_ids
 
     def _format_macro(self, macro: str, prefix: str = "") -> str:
@@ -456,17 +881,19 @@ class Generator:
         if not file_model.functions:
             return
 
-        # Collect matching function lines first to avoid emitting an empty header
-        function_lines: List[str] = []
+        # Collect matching functions first to avoid emitting an empty header;
+        # lines are formatted as they are emitted
+        functions: List[Function] = []
         for func in sorted(file_model.functions, key=lambda x: x.name):
             if is_declaration_only and (func.is_declaration or func.is_inline):
-                function_lines.append(self._format_function_signature(func, prefix))
+                functions.append(func)
             elif not is_declaration_only and not func.is_declaration:
-                function_lines.append(self._format_function_signature(func, prefix))
+                functions.append(func)
 
-        if function_lines:
+        if functions:
             lines.append(f"{INDENT}-- Functions --")
-            lines.extend(function_lines)
+            for func in functions:
+                lines.append(self._format_function_signature(func, prefix))
 
     def _generate_c_file_class(
         self,
@@ -501,17 +928,32 @@ class Generator:
         header_global_names: set[str],
     ):
         """Generate class for header file using unified method with static '+' visibility"""
-        self._generate_file_class_unified(
-            lines=lines,
-            file_model=file_model,
-            uml_ids=uml_ids,
-            header_function_decl_names=header_function_decl_names,
-            header_global_names=header_global_names,
-            class_type="header",
-            color=COLOR_HEADER,
-            macro_prefix="+ ",
-            is_declaration_only=True,
-            use_dynamic_visibility=False,
+        filename = Path(file_model.name).name
+        variant = (
+            uml_ids.get(filename),
+            filename in getattr(self, "_placeholder_headers", set()),
+            getattr(self, "convert_empty_class_to_artifact", False),
+            getattr(self, "hide_macro_values", False),
+            getattr(self, "max_function_signature_chars", 0),
+        )
+        self._cached_fragment(
+            lines,
+            "header",
+            filename,
+            file_model,
+            variant,
+            lambda fragment: self._generate_file_class_unified(
+                lines=fragment,
+                file_model=file_model,
+                uml_ids=uml_ids,
+                header_function_decl_names=header_function_decl_names,
+                header_global_names=header_global_names,
+                class_type="header",
+                color=COLOR_HEADER,
+                macro_prefix="+ ",
+                is_declaration_only=True,
+                use_dynamic_visibility=False,
+            ),
         )
 
     def _generate_file_class_unified(
@@ -582,25 +1024,22 @@ class Generator:
             private_globals = []
             
             for global_var in sorted(file_model.globals, key=lambda x: x.name):
-                prefix = "+ " if global_var.name in header_global_names else "- "
-                formatted_global = self._format_global_variable(global_var, prefix)
-                
-                if prefix == "+ ":
-                    public_globals.append(formatted_global)
+                if global_var.name in header_global_names:
+                    public_globals.append(global_var)
                 else:
-                    private_globals.append(formatted_global)
+                    private_globals.append(global_var)
             
             # Add public globals first
-            for global_line in public_globals:
-                lines.append(global_line)
+            for global_var in public_globals:
+                lines.append(self._format_global_variable(global_var, "+ "))
             
             # Add empty line between public and private if both exist
             if public_globals and private_globals:
                 lines.append("")
             
             # Add private globals
-            for global_line in private_globals:
-                lines.append(global_line)
+            for global_var in private_globals:
+                lines.append(self._format_global_variable(global_var, "- "))
 
     def _add_functions_section_with_visibility(
         self,
@@ -613,37 +1052,33 @@ class Generator:
         if not file_model.functions:
             return
 
-        # Separate functions into public and private groups, collecting first
-        public_functions: List[str] = []
-        private_functions: List[str] = []
+        # Separate functions into public and private groups, collecting first;
+        # lines are formatted as they are emitted
+        public_functions: List[Function] = []
+        private_functions: List[Function] = []
 
         for func in sorted(file_model.functions, key=lambda x: x.name):
             if is_declaration_only and (func.is_declaration or func.is_inline):
-                prefix = "+ "
-                formatted_function = self._format_function_signature(func, prefix)
-                public_functions.append(formatted_function)
+                public_functions.append(func)
             elif not is_declaration_only and not func.is_declaration:
-                prefix = "+ " if func.name in header_function_decl_names else "- "
-                formatted_function = self._format_function_signature(func, prefix)
-
-                if prefix == "+ ":
-                    public_functions.append(formatted_function)
+                if func.name in header_function_decl_names:
+                    public_functions.append(func)
                 else:
-                    private_functions.append(formatted_function)
+                    private_functions.append(func)
 
         if public_functions or private_functions:
             lines.append(f"{INDENT}-- Functions --")
             # Add public functions first
-            for function_line in public_functions:
-                lines.append(function_line)
+            for func in public_functions:
+                lines.append(self._format_function_signature(func, "+ "))
 
             # Add empty line between public and private if both exist
             if public_functions and private_functions:
                 lines.append("")
 
             # Add private functions
-            for function_line in private_functions:
-                lines.append(function_line)
+            for func in private_functions:
+                lines.append(self._format_function_signature(func, "- "))
 
     # Removed O(N^2) header scans in favor of precomputed header visibility sets
 
@@ -915,12 +1350,7 @@ class Generator:
 
     def _is_anonymous_structure_in_project(self, typedef_name: str, project_model: ProjectModel) -> bool:
         """Check if a typedef is an anonymous structure using the provided project model"""
-        for file_model in project_model.files.values():
-            if file_model.anonymous_relationships:
-                for parent_name, children in file_model.anonymous_relationships.items():
-                    if typedef_name in children:
-                        return True
-        return False
+        return ProjectSymbolIndex.for_model(project_model).is_anonymous_structure(typedef_name)
 
     def _generate_uses_relationships(
         self,
@@ -981,23 +1411,20 @@ class Generator:
         relationships_to_generate = []
         
         # Process all files in the project model
-        for file_name, file_model in project_model.files.items():
-            if not file_model.anonymous_relationships:
-                continue
-                
+        symbol_index = ProjectSymbolIndex.for_model(project_model)
+        for _file_name, parent_name, children in symbol_index.anonymous_relationships:
             # Generate relationships for each parent-child pair
-            for parent_name, children in file_model.anonymous_relationships.items():
-                parent_id = self._get_anonymous_uml_id(parent_name, uml_ids)
-                
-                for child_name in children:
-                    # Skip only pure generic placeholders as children (allow suffixed ones)
-                    if child_name in ("__anonymous_struct__", "__anonymous_union__"):
-                        continue
-                    child_id = self._get_anonymous_uml_id(child_name, uml_ids)
-                    
-                    if parent_id and child_id:
-                        has_relationships = True
-                        relationships_to_generate.append(f"{parent_id} *-- {child_id} : <<contains>>")
+            parent_id = self._get_anonymous_uml_id(parent_name, uml_ids)
+
+            for child_name in children:
+                # Skip only pure generic placeholders as children (allow suffixed ones)
+                if child_name in ("__anonymous_struct__", "__anonymous_union__"):
+                    continue
+                child_id = self._get_anonymous_uml_id(child_name, uml_ids)
+
+                if parent_id and child_id:
+                    has_relationships = True
+                    relationships_to_generate.append(f"{parent_id} *-- {child_id} : <<contains>>")
         
         # Only add the section header and relationships if we have any
         if has_relationships:
@@ -1028,10 +1455,6 @@ class Generator:
 
     def _is_anonymous_composition_pair(self, parent_name: str, child_name: str, project_model: ProjectModel) -> bool:
         """Return True if a given parent->child anonymous composition exists in the project model."""
-        for file_model in project_model.files.values():
-            rels = getattr(file_model, "anonymous_relationships", None)
-            if not rels:
-                continue
-            if parent_name in rels and child_name in rels[parent_name]:
-                return True
-        return False
+        return ProjectSymbolIndex.for_model(project_model).is_anonymous_composition_pair(
+            parent_name, child_name
+        )
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+Project-wide include graph for the transformer.
+
+The graph is built once per run from the files' include lists. Depth-bounded
+include closures (file -> shortest include distance) are memoized per header
+and shared by every root file, so common header chains are walked once
+instead of once per .c file. Cyclic includes are handled by condensing the
+graph into strongly connected components: distances inside a component come
+from one local BFS and everything beyond it is composed from the cached
+closures of the headers the component includes.
+"""
+
+import math
+from typing import Dict, List, Optional, Tuple
+
+from ..models import FileModel
+from .pattern_engine import PatternMatcher
+
+# (bound, distances, farthest distance); bound is math.inf for a closure that
+# contains everything reachable
+_ClosureEntry = Tuple[float, Dict[str, int], int]
+
+
+class IncludeGraph:
+    """Include edges between project files, keyed by file name"""
+
+    def __init__(self, file_map: Dict[str, FileModel]):
+        # Sorted, de-duplicated includes that resolve to another project file
+        self.adjacency: Dict[str, Tuple[str, ...]] = {
+            name: tuple(sorted({
+                include_name for include_name in file_model.includes
+                if include_name in file_map and include_name != name
+            }))
+            for name, file_model in file_map.items()
+        }
+        self._views: Dict[Tuple[str, ...], "IncludeView"] = {}
+
+    def view(self, filter_key: Tuple[str, ...], matcher: Optional[PatternMatcher] = None) -> "IncludeView":
+        """Return the cached view that only follows includes accepted by matcher
+
+        filter_key identifies the matcher's pattern list; views with the same
+        filters share their closures.
+        """
+        view = self._views.get(filter_key)
+        if view is None:
+            view = IncludeView(self.adjacency, matcher)
+            self._views[filter_key] = view
+        return view
+
+
+class IncludeView:
+    """Memoized include closures over the includes a filter lets through"""
+
+    def __init__(self, adjacency: Dict[str, Tuple[str, ...]], matcher: Optional[PatternMatcher]):
+        if matcher is not None and matcher.has_patterns:
+            self.successors = {
+                name: tuple(include_name for include_name in includes if matcher.matches(include_name))
+                for name, includes in adjacency.items()
+            }
+        else:
+            self.successors = dict(adjacency)
+        self._component = self._strongly_connected_components()
+        self._component_size: Dict[int, int] = {}
+        for component in self._component.values():
+            self._component_size[component] = self._component_size.get(component, 0) + 1
+        self._closures: Dict[str, _ClosureEntry] = {}
+        self._local: Dict[str, Dict[str, int]] = {}
+
+    def _strongly_connected_components(self) -> Dict[str, int]:
+        """Label every file with its component id (iterative Tarjan)"""
+        index: Dict[str, int] = {}
+        lowlink: Dict[str, int] = {}
+        component: Dict[str, int] = {}
+        stack: List[str] = []
+        on_stack = set()
+        counter = 0
+        component_count = 0
+
+        for start in self.successors:
+            if start in index:
+                continue
+            work = [(start, 0)]
+            while work:
+                name, position = work.pop()
+                if position == 0:
+                    index[name] = lowlink[name] = counter
+                    counter += 1
+                    stack.append(name)
+                    on_stack.add(name)
+                successors = self.successors[name]
+                while position < len(successors):
+                    target = successors[position]
+                    position += 1
+                    if target not in index:
+                        work.append((name, position))
+                        work.append((target, 0))
+                        break
+                    if target in on_stack:
+                        lowlink[name] = min(lowlink[name], index[target])
+                else:
+                    if lowlink[name] == index[name]:
+                        component_id = component_count
+                        component_count += 1
+                        while True:
+                            member = stack.pop()
+                            on_stack.discard(member)
+                            component[member] = component_id
+                            if member == name:
+                                break
+                    if work:
+                        parent = work[-1][0]
+                        lowlink[parent] = min(lowlink[parent], lowlink[name])
+        return component
+
+    def _local_distances(self, name: str) -> Dict[str, int]:
+        """Return distances from name to the files of its own component"""
+        local = self._local.get(name)
+        if local is not None:
+            return local
+
+        component = self._component[name]
+        local = {name: 0}
+        if self._component_size[component] > 1:
+            level = [name]
+            distance = 0
+            while level:
+                distance += 1
+                next_level = []
+                for current in level:
+                    for target in self.successors[current]:
+                        if target not in local and self._component[target] == component:
+                            local[target] = distance
+                            next_level.append(target)
+                level = next_level
+        self._local[name] = local
+        return local
+
+    def closure(self, name: str, depth: int) -> Dict[str, int]:
+        """Return the shortest include distance of every file within depth of name
+
+        The returned mapping is shared with the cache and must not be modified.
+        """
+        return self._closure(name, depth)[0]
+
+    def _closure(self, name: str, depth: int) -> Tuple[Dict[str, int], bool]:
+        cached = self._closures.get(name)
+        if cached is not None and cached[0] >= depth:
+            bound, distances, farthest = cached
+            if farthest <= depth:
+                return distances, bound == math.inf
+            return {target: distance for target, distance in distances.items() if distance <= depth}, False
+
+        component = self._component[name]
+        distances: Dict[str, int] = {}
+        complete = True
+        local = self._local_distances(name)
+        for member, member_distance in local.items():
+            if member_distance <= depth:
+                distances[member] = member_distance
+            else:
+                complete = False
+
+        # A path that leaves the component never returns to it, so distances
+        # beyond it compose from the closures of the files it includes
+        for member, member_distance in local.items():
+            exits = [target for target in self.successors[member] if self._component[target] != component]
+            if member_distance >= depth:
+                complete = complete and not exits
+                continue
+            for target in exits:
+                offset = member_distance + 1
+                sub_distances, sub_complete = self._closure(target, depth - offset)
+                complete = complete and sub_complete
+                for sub_target, sub_distance in sub_distances.items():
+                    distance = sub_distance + offset
+                    if distance < distances.get(sub_target, math.inf):
+                        distances[sub_target] = distance
+
+        farthest = max(distances.values())
+        self._closures[name] = (math.inf if complete else depth, distances, farthest)
+        return distances, complete
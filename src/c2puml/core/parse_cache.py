@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Persistent parse cache for the C to PlantUML converter.
+
+Stores the serialized FileModel of every parsed file on disk so that unchanged
+files can skip tokenization and parsing on the next run. An entry is only
+reused when the file path, content hash, tool version, define set and parser
+options match. Entries also keep the model verification issues of their
+FileModel, so cached files are not verified again.
+"""
+
+import hashlib
+import json
+import logging
+import os
+from pathlib import Path
+from typing import Dict, Iterable, List, Optional, Tuple
+
+from .. import __version__
+from ..models import FileModel
+
+CACHE_FORMAT_VERSION = 1
+
+
+class ParseCache:
+    """On-disk cache of parsed FileModels, one JSON entry per source file"""
+
+    def __init__(
+        self,
+        cache_dir: str,
+        defines: Optional[Dict[str, str]] = None,
+        options: Optional[Dict[str, str]] = None,
+    ):
+        self.logger = logging.getLogger(__name__)
+        self.cache_dir = Path(cache_dir)
+        self.defines = dict(defines or {})
+        self.define_key = self._make_define_key(self.defines)
+        # Parser options that change the parsed model (e.g. anonymous_extraction)
+        self.options = dict(options or {})
+        self.options_key = self._make_define_key(self.options)
+        self.hits = 0
+        self.misses = 0
+
+    @staticmethod
+    def _make_define_key(defines: Dict[str, str]) -> str:
+        """Create a stable fingerprint for the effective define set (or option set)"""
+        data = json.dumps(sorted(defines.items()), ensure_ascii=False)
+        return hashlib.sha256(data.encode("utf-8")).hexdigest()
+
+    @staticmethod
+    def defines_from_evaluator(defined_macros: Iterable[str], macro_values: Dict[str, str]) -> Dict[str, str]:
+        """Build the define set from a preprocessor evaluator's state"""
+        return {name: macro_values.get(name, "") for name in defined_macros}
+
+    @staticmethod
+    def content_hash(file_path: Path) -> str:
+        """Return the SHA-256 digest of a file's raw content"""
+        with open(file_path, "rb") as f:
+            return ParseCache.hash_bytes(f.read())
+
+    @staticmethod
+    def hash_bytes(data) -> str:
+        """Return the SHA-256 digest of an in-memory file buffer"""
+        return hashlib.sha256(data).hexdigest()
+
+    def _entry_path(self, file_path: Path) -> Path:
+        """Return the cache entry location for a source file"""
+        path_key = hashlib.sha1(str(file_path).encode("utf-8")).hexdigest()
+        return self.cache_dir / f"{path_key}.json"
+
+    def get(self, file_path: Path, relative_path: str, content_hash: str) -> Optional[FileModel]:
+        """Return the cached FileModel for a file, or None if there is no valid entry"""
+        return self.get_verified(file_path, relative_path, content_hash)[0]
+
+    def get_verified(
+        self, file_path: Path, relative_path: str, content_hash: str
+    ) -> Tuple[Optional[FileModel], Optional[List[str]]]:
+        """Return the cached FileModel and its verification issues
+
+        The issues are None when the entry was stored without verification.
+        """
+        entry_path = self._entry_path(file_path)
+        try:
+            with open(entry_path, "r", encoding="utf-8") as f:
+                entry = json.load(f)
+            if (
+                entry.get("format") == CACHE_FORMAT_VERSION
+                and entry.get("path") == str(file_path)
+                and entry.get("relative_path") == relative_path
+                and entry.get("content_hash") == content_hash
+                and entry.get("tool_version") == __version__
+                and entry.get("define_key") == self.define_key
+                and entry.get("options_key") == self.options_key
+            ):
+                file_model = FileModel.from_dict(entry["file_model"])
+                issues = entry.get("verification_issues")
+                self.hits += 1
+                return file_model, (list(issues) if isinstance(issues, list) else None)
+        except FileNotFoundError:
+            pass
+        except (OSError, ValueError, KeyError, TypeError) as e:
+            self.logger.debug("Ignoring unreadable cache entry %s: %s", entry_path, e)
+
+        self.misses += 1
+        return None, None
+
+    def record(self, hit: bool) -> None:
+        """Count a lookup done by another ParseCache instance (e.g. in a worker process)"""
+        if hit:
+            self.hits += 1
+        else:
+            self.misses += 1
+
+    def put(
+        self,
+        file_path: Path,
+        relative_path: str,
+        content_hash: str,
+        file_model: FileModel,
+        verification_issues: Optional[List[str]] = None,
+    ) -> None:
+        """Store a freshly parsed FileModel (and its verification issues, if checked)"""
+        entry = {
+            "format": CACHE_FORMAT_VERSION,
+            "path": str(file_path),
+            "relative_path": relative_path,
+            "content_hash": content_hash,
+            "tool_version": __version__,
+            "define_key": self.define_key,
+            "options_key": self.options_key,
+            "file_model": file_model.to_dict(),
+        }
+        if verification_issues is not None:
+            entry["verification_issues"] = list(verification_issues)
+        entry_path = self._entry_path(file_path)
+        tmp_path = entry_path.with_suffix(f".{os.getpid()}.tmp")
+        try:
+            self.cache_dir.mkdir(parents=True, exist_ok=True)
+            with open(tmp_path, "w", encoding="utf-8") as f:
+                json.dump(entry, f, ensure_ascii=False)
+            # Atomic replace so concurrent runs never observe a partial entry
+            os.replace(tmp_path, entry_path)
+        except (OSError, TypeError, ValueError) as e:
+            self.logger.warning("Failed to write parse cache entry for %s: %s", file_path, e)
+            try:
+                os.remove(tmp_path)
+            except OSError:
+                pass
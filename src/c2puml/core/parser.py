@@ -3,20 +3,37 @@
 Parser module for C to PlantUML converter - Step 1: Parse C code files and generate model.json
 """
 import logging
+import os
+from concurrent.futures import ProcessPoolExecutor
 from pathlib import Path
-from typing import TYPE_CHECKING, Dict, List, Optional, Set
+from typing import TYPE_CHECKING, Dict, List, Optional, Set, Tuple
 
 from ..models import Enum, EnumValue, Field, FileModel, ProjectModel, Struct
 from .parser_tokenizer import (
     CTokenizer,
     StructureFinder,
+    Token,
     TokenType,
     find_enum_values,
     find_struct_fields,
 )
-from .preprocessor import PreprocessorManager
-from .parser_anonymous_processor import AnonymousTypedefProcessor
-from ..utils import detect_file_encoding
+from .discovery import SourceDiscovery
+from .parse_cache import ParseCache
+from .sharding import ShardPlan
+from .profiler import PROFILER
+from .source_reader import SourceReader, SourceText
+from .verifier import VERIFY_MODES, ModelVerifier, in_verification_sample
+from .preprocessor import (
+    HEADER_EXTENSIONS,
+    PREPROCESSOR_MODES,
+    PreprocessorManager,
+    TranslationUnitPreprocessor,
+)
+from .parser_anonymous_processor import (
+    ANONYMOUS_EXTRACTION_MODES,
+    AnonymousStructureRegistry,
+    AnonymousTypedefProcessor,
+)
 import re
 from .parse_utils import (
     clean_type_string,
@@ -34,6 +51,73 @@ if TYPE_CHECKING:
     from ..config import Config
     from ..models import Alias, Enum, Field, Function, Struct, Union
 
+# Per-process parser instance and parse cache used by the parallel parse workers
+_WORKER_PARSER = None
+_WORKER_CACHE = None
+
+
+def _init_parse_worker(
+    tokenizer_engine: str = "line",
+    cache_args: Optional[tuple] = None,
+    mmap_threshold: int = 0,
+    profile_memory: Optional[bool] = None,
+    anonymous_extraction: str = "text",
+    translation_unit_args: Optional[tuple] = None,
+    verify_args: Optional[tuple] = None,
+):
+    """Create the parser instance (and parse cache view) reused by a worker process
+
+    profile_memory is None unless the main process profiles the run;
+    translation_unit_args (header paths, base defines, snapshots) is set in
+    translation_unit preprocessor mode; verify_args is (verify mode, sample rate).
+    """
+    global _WORKER_PARSER, _WORKER_CACHE
+    if profile_memory is not None:
+        PROFILER.start(trace_memory=profile_memory)
+    _WORKER_PARSER = CParser()
+    _WORKER_PARSER.tokenizer.engine = tokenizer_engine
+    _WORKER_PARSER.reader.mmap_threshold = mmap_threshold
+    _WORKER_PARSER.anonymous_extraction = anonymous_extraction
+    if verify_args is not None:
+        _WORKER_PARSER.verify_mode, _WORKER_PARSER.verify_sample_rate = verify_args
+    if translation_unit_args is not None:
+        header_paths, base_defines, snapshots = translation_unit_args
+        _WORKER_PARSER.preprocessor_mode = "translation_unit"
+        _WORKER_PARSER.translation_units = TranslationUnitPreprocessor(
+            header_paths, _WORKER_PARSER._load_tokens, base_defines, snapshots
+        )
+    _WORKER_CACHE = ParseCache(*cache_args) if cache_args else None
+
+
+def _parse_file_worker(file_path: str, relative_path: str):
+    """Parse a single file in a worker process
+
+    Returns the _parse_one result tuple so that per-file failures are reported
+    back to the main process instead of aborting the whole pool, together with
+    the worker's profile snapshot (None when the run is not profiled).
+    """
+    result = _WORKER_PARSER._parse_one(Path(file_path), relative_path, _WORKER_CACHE)
+    return result, PROFILER.drain()
+
+
+def deduplicate_anonymous_structures(
+    files: Dict[str, FileModel], logger: Optional[logging.Logger] = None
+) -> Dict[str, FileModel]:
+    """Return the files with identical anonymous layouts stored once (see AnonymousStructureRegistry)"""
+    registry = AnonymousStructureRegistry()
+    deduplicated = registry.deduplicate(files)
+    if logger:
+        removed = sum(
+            len(files[key].structs) + len(files[key].unions)
+            - len(file_model.structs) - len(file_model.unions)
+            for key, file_model in deduplicated.items()
+        )
+        logger.info(
+            "Anonymous deduplication: %d layouts, %d duplicate entities removed",
+            len(registry), removed,
+        )
+    return deduplicated
+
 
 class CParser:
     """C/C++ parser for extracting structural information from source code using tokenization"""
@@ -42,6 +126,73 @@ class CParser:
         self.logger = logging.getLogger(__name__)
         self.tokenizer = CTokenizer()
         self.preprocessor = PreprocessorManager()
+        self.reader = SourceReader()
+        self.anonymous_extraction = "text"
+        self.preprocessor_mode = "project"
+        # Header define snapshots used in translation_unit preprocessor mode
+        self.translation_units: Optional[TranslationUnitPreprocessor] = None
+        # Per-file model verification while parsing (see ModelVerifier.verify_model);
+        # "off" by default, Parser.parse_model sets it from the configuration
+        self.verify_mode = "off"
+        self.verify_sample_rate = 1.0
+        # Verification issues of the parsed files by model key, for verify_model
+        self.file_issues: Dict[str, List[str]] = {}
+        self._verifier: Optional[ModelVerifier] = None
+        # Paths to parse (None: all discovered files); set for sharded runs
+        self.file_selection: Optional[Set[str]] = None
+
+    @property
+    def anonymous_extraction(self) -> str:
+        """How nested anonymous structures are parsed: text (body text) or tokens"""
+        return self._anonymous_extraction
+
+    @anonymous_extraction.setter
+    def anonymous_extraction(self, mode: str) -> None:
+        if mode not in ANONYMOUS_EXTRACTION_MODES:
+            raise ValueError(
+                f"Unknown anonymous extraction mode '{mode}', expected one of: "
+                f"{', '.join(ANONYMOUS_EXTRACTION_MODES)}"
+            )
+        self._anonymous_extraction = mode
+
+    @property
+    def preprocessor_mode(self) -> str:
+        """How #if conditions see macros: project (shared define state) or translation_unit"""
+        return self._preprocessor_mode
+
+    @preprocessor_mode.setter
+    def preprocessor_mode(self, mode: str) -> None:
+        if mode not in PREPROCESSOR_MODES:
+            raise ValueError(
+                f"Unknown preprocessor mode '{mode}', expected one of: "
+                f"{', '.join(PREPROCESSOR_MODES)}"
+            )
+        self._preprocessor_mode = mode
+
+    @property
+    def verify_mode(self) -> str:
+        """Model verification of parsed files: full, sample or off"""
+        return self._verify_mode
+
+    @verify_mode.setter
+    def verify_mode(self, mode: str) -> None:
+        if mode not in VERIFY_MODES:
+            raise ValueError(
+                f"Unknown verify mode '{mode}', expected one of: {', '.join(VERIFY_MODES)}"
+            )
+        self._verify_mode = mode
+
+    def _verify_parsed(self, file_model: FileModel) -> Optional[List[str]]:
+        """Return the verification issues of a parsed file, or None if it is not checked"""
+        if self.verify_mode == "off":
+            return None
+        if self.verify_mode == "sample" and not in_verification_sample(
+            file_model.name, self.verify_sample_rate
+        ):
+            return None
+        if self._verifier is None:
+            self._verifier = ModelVerifier()
+        return self._verifier.verify_file_model(file_model.name, file_model)
 
     def parse_project(
         self, source_folder: str, recursive_search: bool = True, config: "Config" = None
@@ -100,55 +251,70 @@ class CParser:
 
         self.logger.info("Parsing project: %s", source_folder_path)
 
-        # Find all C/C++ files in the project
+        # Find all C/C++ files in the project, applying the file filters while walking
+        discovery = SourceDiscovery.from_config(config) if config else SourceDiscovery()
         try:
-            all_c_files = self._find_c_files(source_folder_path, recursive_search)
+            c_files = discovery.find(source_folder_path, recursive_search)
         except OSError as e:
             raise ValueError(f"Error searching for C/C++ files in '{source_folder_path}': {e}")
-        
-        self.logger.info("Found %d C/C++ files", len(all_c_files))
-
-        # Apply file filtering based on configuration
-        c_files = []
-        if config:
-            for file_path in all_c_files:
-                if config._should_include_file(file_path.name):
-                    c_files.append(file_path)
-                    self.logger.debug(
-                        "Included file after filtering: %s", file_path.name
-                    )
-                else:
-                    self.logger.debug(
-                        "Excluded file after filtering: %s", file_path.name
-                    )
-        else:
-            c_files = all_c_files
 
+        self.logger.info("Found %d C/C++ files", discovery.matched)
         self.logger.info("After filtering: %d C/C++ files", len(c_files))
 
         # Parse each file using filename as key for simplified tracking
         files = {}
         failed_files = []
 
-        for file_path in c_files:
-            try:
-                # Use relative path for tracking and filename as key
-                relative_path = str(file_path.relative_to(source_folder_path))
-                file_model = self.parse_file(file_path, relative_path)
-
-                # Use filename as key (filenames are guaranteed to be unique)
-                if file_model.name in files:
-                    raise RuntimeError(
-                        f"Duplicate filename detected: '{file_model.name}' from '{file_path}'. "
-                        f"Already seen from '{files[file_model.name].file_path}'."
-                    )
-                files[file_model.name] = file_model
+        if config:
+            self.tokenizer.engine = getattr(config, "tokenizer_engine", "line")
+            self.reader.mmap_threshold = getattr(config, "mmap_threshold", 0)
+            self.anonymous_extraction = getattr(config, "anonymous_extraction", "text")
+            self.preprocessor_mode = getattr(config, "preprocessor_mode", "project")
+
+        if self.preprocessor_mode == "translation_unit":
+            self.translation_units = self._create_translation_units(
+                source_folder_path, c_files, recursive_search, config
+            )
+
+        # Header snapshots above cover all headers; a shard only parses its own files
+        if self.file_selection is not None:
+            c_files = [path for path in c_files if str(path) in self.file_selection]
+            self.logger.info("Parsing %d C/C++ files of this shard", len(c_files))
+
+        jobs = self._resolve_jobs(getattr(config, "jobs", 1) if config else 1)
+        relative_paths = [
+            str(file_path.relative_to(source_folder_path)) for file_path in c_files
+        ]
 
-                self.logger.debug("Successfully parsed: %s", relative_path)
+        bytes_before = self.reader.bytes_read
+        seconds_before = self.reader.read_seconds
+        results = self._parse_files_cached(c_files, relative_paths, jobs, config)
 
-            except (OSError, ValueError) as e:
-                self.logger.warning("Failed to parse %s: %s", file_path, e)
+        # Results are merged in the sorted discovery order regardless of job count
+        for file_path, relative_path, file_model, error, issues in results:
+            if error is not None:
+                self.logger.warning("Failed to parse %s: %s", file_path, error)
                 failed_files.append(str(file_path))
+                continue
+
+            # Use filename as key (filenames are guaranteed to be unique)
+            if file_model.name in files:
+                raise RuntimeError(
+                    f"Duplicate filename detected: '{file_model.name}' from '{file_path}'. "
+                    f"Already seen from '{files[file_model.name].file_path}'."
+                )
+            files[file_model.name] = file_model
+            if issues is not None:
+                self.file_issues[file_model.name] = issues
+
+            self.logger.debug("Successfully parsed: %s", relative_path)
+
+        self.logger.info(
+            "Read %d bytes from %d files in %.3fs",
+            self.reader.bytes_read - bytes_before,
+            len(c_files),
+            self.reader.read_seconds - seconds_before,
+        )
 
         if failed_files:
             error_msg = (
@@ -165,93 +331,316 @@ class CParser:
         )
 
         # Update all uses fields across the entire project
-        model.update_uses_fields()
+        with PROFILER.stage("parse.uses_update"):
+            model.update_uses_fields()
 
         self.logger.info("Parsing complete. Parsed %d files successfully.", len(files))
         return model
 
-    def parse_file(self, file_path: Path, relative_path: str) -> FileModel:
-        """Parse a single C/C++ file and return a file model using tokenization"""
-        self.logger.debug("Parsing file: %s", file_path)
+    def _resolve_jobs(self, jobs) -> int:
+        """Return the effective number of parser worker processes"""
+        try:
+            jobs = int(jobs)
+        except (TypeError, ValueError):
+            self.logger.warning("Invalid jobs value '%s', parsing serially", jobs)
+            return 1
+        if jobs <= 0:
+            return os.cpu_count() or 1
+        return jobs
+
+    def _create_translation_units(
+        self,
+        source_folder_path: Path,
+        c_files: List[Path],
+        recursive_search: bool,
+        config: "Config" = None,
+    ) -> TranslationUnitPreprocessor:
+        """Compute the define snapshots of the headers in all configured source folders
+
+        Only headers that pass the file filters are known, as in the watch
+        session. The snapshots of an earlier folder of the same run are reused
+        when the header set is the same.
+        """
+        header_paths = {str(path) for path in c_files if path.suffix in HEADER_EXTENSIONS}
+        discovery = SourceDiscovery.from_config(config) if config else None
+        for folder in getattr(config, "source_folders", None) or []:
+            folder_path = Path(folder).resolve()
+            if folder_path != source_folder_path and folder_path.is_dir():
+                header_paths.update(
+                    str(path) for path in discovery.find(folder_path, recursive_search)
+                    if path.suffix in HEADER_EXTENSIONS
+                )
+        evaluator = self.preprocessor.evaluator
+        base_defines = ParseCache.defines_from_evaluator(
+            evaluator.defined_macros, evaluator.macro_values
+        )
+        units = TranslationUnitPreprocessor(header_paths, self._load_tokens, base_defines)
+        previous = self.translation_units
+        if (
+            previous is not None
+            and previous.header_paths == units.header_paths
+            and previous.base_defines == units.base_defines
+        ):
+            return previous
+        with PROFILER.stage("parse.header_defines"):
+            units.compute_all()
+        self.logger.info("Computed define snapshots of %d headers", len(units.snapshots))
+        return units
+
+    def _load_tokens(self, file_path: Path) -> List[Token]:
+        """Read and tokenize a file (used for header define snapshots)"""
+        return self.tokenizer.tokenize(self.reader.read(file_path).content)
+
+    def _create_parse_cache(self, config: "Config") -> Optional[ParseCache]:
+        """Create the parse cache if it is enabled in the configuration"""
+        if not config or not getattr(config, "parse_cache", False):
+            return None
+        cache_dir = getattr(config, "parse_cache_dir", "") or os.path.join(
+            getattr(config, "output_dir", "./output"), ".parse_cache"
+        )
+        evaluator = self.preprocessor.evaluator
+        defines = ParseCache.defines_from_evaluator(
+            evaluator.defined_macros, evaluator.macro_values
+        )
+        options = {"anonymous_extraction": self.anonymous_extraction}
+        if self.preprocessor_mode == "translation_unit" and self.translation_units is not None:
+            # Any change to a header's exported defines invalidates every entry
+            options["preprocessor_mode"] = self.preprocessor_mode
+            options["header_defines"] = ParseCache._make_define_key(
+                {path: repr(snapshot.changes) for path, snapshot in self.translation_units.snapshots.items()}
+            )
+        return ParseCache(cache_dir, defines, options)
 
-        # Detect encoding
-        encoding = self._detect_encoding(file_path)
+    def _parse_files_cached(
+        self, c_files: List[Path], relative_paths: List[str], jobs: int, config: "Config"
+    ) -> list:
+        """Parse files, reusing valid parse cache entries when the cache is enabled
 
-        # Read file content
-        with open(file_path, "r", encoding=encoding) as f:
-            content = f.read()
+        Returns (file_path, relative_path, file_model, error, issues) tuples in
+        input order; issues are the file's verification issues (None if unchecked).
+        """
+        cache = self._create_parse_cache(config)
+        results = list(self._parse_files(c_files, relative_paths, jobs, cache))
+        if cache is not None:
+            self.logger.info(
+                "Parse cache: %d hits, %d misses (%s)", cache.hits, cache.misses, cache.cache_dir
+            )
+        return results
+
+    def _parse_one(self, file_path: Path, relative_path: str, cache: Optional[ParseCache]):
+        """Read a file once, then serve it from the parse cache or parse it
+
+        Returns (file_model, error, cache_hit, bytes_read, read_seconds, issues);
+        cache_hit is None when there is no cache or the file could not be read.
+        issues are the verification issues, reused from the cache entry when it
+        has them, or None when the file is not verified (see verify_mode).
+        """
+        try:
+            source = self.reader.read(file_path, with_hash=cache is not None)
+        except (OSError, ValueError) as e:
+            return None, str(e), None, 0, 0.0, None
+
+        cache_hit = None
+        if cache is not None:
+            file_model, issues = cache.get_verified(file_path, relative_path, source.content_hash)
+            if file_model is not None:
+                if issues is None:
+                    issues = self._verify_parsed(file_model)
+                return file_model, None, True, source.size, source.read_seconds, issues
+            cache_hit = False
+
+        try:
+            with PROFILER.file(relative_path):
+                file_model = self.parse_file(file_path, relative_path, source)
+        except (OSError, ValueError) as e:
+            return None, str(e), cache_hit, source.size, source.read_seconds, None
+        issues = self._verify_parsed(file_model)
+        if cache is not None:
+            cache.put(file_path, relative_path, source.content_hash, file_model, issues)
+        return file_model, None, cache_hit, source.size, source.read_seconds, issues
+
+    def _parse_files(
+        self,
+        c_files: List[Path],
+        relative_paths: List[str],
+        jobs: int,
+        cache: Optional[ParseCache] = None,
+    ):
+        """Parse files serially or with a worker pool, yielding results in input order
+
+        Yields (file_path, relative_path, file_model, error, issues) tuples where
+        error is None on success. Workers read, cache and parse files themselves; their
+        read and cache counters are added to this parser's reader and cache.
+        """
+        jobs = min(jobs, len(c_files))
+        if jobs > 1:
+            cache_args = (
+                (str(cache.cache_dir), cache.defines, cache.options) if cache is not None else None
+            )
+            profile_memory = PROFILER.trace_memory if PROFILER.enabled else None
+            try:
+                executor = ProcessPoolExecutor(
+                    max_workers=jobs,
+                    initializer=_init_parse_worker,
+                    initargs=(
+                        self.tokenizer.engine,
+                        cache_args,
+                        self.reader.mmap_threshold,
+                        profile_memory,
+                        self.anonymous_extraction,
+                        self._translation_unit_args(),
+                        (self.verify_mode, self.verify_sample_rate),
+                    ),
+                )
+            except (OSError, NotImplementedError) as e:
+                self.logger.warning(
+                    "Parallel parsing unavailable (%s), parsing serially", e
+                )
+            else:
+                self.logger.info("Parsing with %d worker processes", jobs)
+                chunksize = max(1, len(c_files) // (jobs * 4))
+                with executor:
+                    results = executor.map(
+                        _parse_file_worker,
+                        [str(file_path) for file_path in c_files],
+                        relative_paths,
+                        chunksize=chunksize,
+                    )
+                    for file_path, relative_path, (result, profile) in zip(
+                        c_files, relative_paths, results
+                    ):
+                        PROFILER.merge(profile)
+                        file_model, error, cache_hit, size, read_seconds, issues = result
+                        if size or read_seconds:
+                            self.reader.record(size, read_seconds)
+                        if cache_hit is not None:
+                            cache.record(cache_hit)
+                        yield file_path, relative_path, file_model, error, issues
+                return
+
+        for file_path, relative_path in zip(c_files, relative_paths):
+            file_model, error, _, _, _, issues = self._parse_one(file_path, relative_path, cache)
+            yield file_path, relative_path, file_model, error, issues
+
+    def _translation_unit_args(self) -> Optional[tuple]:
+        """Return the worker initializer arguments of translation_unit mode"""
+        units = self.translation_units
+        if self.preprocessor_mode != "translation_unit" or units is None:
+            return None
+        return units.header_paths, units.base_defines, units.snapshots
+
+    def parse_file(
+        self, file_path: Path, relative_path: str, source: Optional[SourceText] = None
+    ) -> FileModel:
+        """Parse a single C/C++ file and return a file model using tokenization
+
+        source is the already read and decoded file; it is read here otherwise.
+        The text is taken over from source so it can be released after tokenizing.
+        """
+        self.logger.debug("Parsing file: %s", file_path)
+
+        # Read the file once and decode it from the buffer
+        if source is None:
+            source = self.reader.read(file_path)
+        content, source.content = source.content, ""
 
         # Tokenize the content
-        tokens = self.tokenizer.tokenize(content)
-        self.logger.debug("Tokenized file into %d tokens", len(tokens))
+        with PROFILER.stage("parse.tokenize"):
+            tokens = self.tokenizer.tokenize(content)
+        del content
+        token_count = len(tokens)
+        PROFILER.note(tokens=token_count)
+        self.logger.debug("Tokenized file into %d tokens", token_count)
 
         # Process preprocessor directives
-        self.preprocessor.add_defines_from_content(tokens)
-        processed_tokens = self.preprocessor.process_file(tokens)
+        with PROFILER.stage("parse.preprocess"):
+            if self.preprocessor_mode == "translation_unit" and self.translation_units is not None:
+                processed_tokens = self.translation_units.process_file(file_path, tokens)
+            else:
+                self.preprocessor.add_defines_from_content(tokens)
+                processed_tokens = self.preprocessor.process_file(tokens)
+        # Only the preprocessed stream is needed from here on; release the raw
+        # token list (inactive blocks included) to lower peak memory
+        del tokens
         self.logger.debug(
             "Preprocessor processed %d tokens -> %d tokens",
-            len(tokens),
+            token_count,
             len(processed_tokens),
         )
 
-        # Filter out whitespace and comments for structure finding
-        filtered_tokens = self.tokenizer.filter_tokens(processed_tokens)
-        structure_finder = StructureFinder(filtered_tokens)
-
-        # Parse different structures using tokenizer
-        structs = self._parse_structs_with_tokenizer(processed_tokens, structure_finder)
-        enums = self._parse_enums_with_tokenizer(processed_tokens, structure_finder)
-        unions = self._parse_unions_with_tokenizer(processed_tokens, structure_finder)
-        functions = self._parse_functions_with_tokenizer(
-            processed_tokens, structure_finder
-        )
-        aliases = self._parse_aliases_with_tokenizer(processed_tokens)
-
-        # "uses" fields will be updated when we have the full project model
-
-        # Map typedef names to anonymous structs/enums/unions if needed
-        # This logic will be handled by typedef_relations instead
-
-        file_model = FileModel(
-            file_path=str(file_path),
-            structs=structs,
-            enums=enums,
-            unions=unions,
-            functions=functions,
-            globals=self._parse_globals_with_tokenizer(processed_tokens),
-            includes=self._parse_includes_with_tokenizer(processed_tokens),
-            macros=self._parse_macros_with_tokenizer(processed_tokens),
-            aliases=aliases,
-            # Tag names are now stored in struct/enum/union objects
-        )
+        with PROFILER.stage("parse.structure_finding"):
+            # Filter out whitespace and comments for structure finding
+            filtered_tokens, positions = self.tokenizer.filter_tokens_with_positions(
+                processed_tokens
+            )
+            structure_finder = StructureFinder(filtered_tokens, positions)
+
+            # One walk finds every struct, enum, union and function; one walk
+            # over the typedefs serves both the aliases and the tag names
+            scan = structure_finder.scan_declarations()
+            typedefs = self._scan_typedefs(processed_tokens)
+            typedef_tags = self._typedef_tag_names(processed_tokens, typedefs)
+            # Tokens of nested anonymous bodies, for token based anonymous extraction
+            nested_bodies = {} if self.anonymous_extraction == "tokens" else None
+
+            # Parse different structures using tokenizer
+            structs = self._parse_structs_with_tokenizer(
+                processed_tokens, structure_finder, scan.structs, typedef_tags, nested_bodies
+            )
+            enums = self._parse_enums_with_tokenizer(
+                processed_tokens, structure_finder, scan.enums, typedef_tags
+            )
+            unions = self._parse_unions_with_tokenizer(
+                processed_tokens, structure_finder, scan.unions, typedef_tags, nested_bodies
+            )
+            functions = self._parse_functions_with_tokenizer(
+                processed_tokens, structure_finder, scan.functions
+            )
+            aliases = self._parse_aliases_with_tokenizer(typedefs)
+            includes, macros = self._parse_directives_with_tokenizer(processed_tokens)
+
+            # "uses" fields will be updated when we have the full project model
+
+            # Map typedef names to anonymous structs/enums/unions if needed
+            # This logic will be handled by typedef_relations instead
+
+            file_model = FileModel(
+                file_path=str(file_path),
+                structs=structs,
+                enums=enums,
+                unions=unions,
+                functions=functions,
+                globals=self._parse_globals_with_tokenizer(processed_tokens),
+                includes=includes,
+                macros=macros,
+                aliases=aliases,
+                # Tag names are now stored in struct/enum/union objects
+            )
 
         # Process anonymous typedefs after initial parsing
-        anonymous_processor = AnonymousTypedefProcessor()
-        anonymous_processor.process_file_model(file_model)
+        with PROFILER.stage("parse.anonymous_processing"):
+            anonymous_processor = AnonymousTypedefProcessor(nested_bodies)
+            anonymous_processor.process_file_model(file_model)
 
         return file_model
 
     def _parse_structs_with_tokenizer(
-        self, tokens, structure_finder
+        self, tokens, structure_finder, struct_infos, typedef_tags, nested_bodies=None
     ) -> Dict[str, "Struct"]:
-        """Parse struct definitions using tokenizer"""
+        """Parse the struct definitions found by the declaration scan"""
 
         structs = {}
-        struct_infos = structure_finder.find_structs()
 
         for start_pos, end_pos, struct_name in struct_infos:
             # Need to map back to original token positions
-            # Find the original token positions by looking at line/column info
-            original_start = self._find_original_token_pos(
-                tokens, structure_finder.tokens, start_pos
-            )
-            original_end = self._find_original_token_pos(
-                tokens, structure_finder.tokens, end_pos
-            )
+            original_start = self._find_original_token_pos(structure_finder, start_pos)
+            original_end = self._find_original_token_pos(structure_finder, end_pos)
 
             if original_start is not None and original_end is not None:
                 # Extract field information from original token range
-                field_tuples = find_struct_fields(tokens, original_start, original_end)
+                field_tuples = find_struct_fields(
+                    tokens, original_start, original_end, nested_bodies
+                )
 
                 # Convert to Field objects
                 fields = []
@@ -271,7 +660,7 @@ class CParser:
                 tag_name = ""
                 if struct_name and not struct_name.startswith("__anonymous"):
                     # Check if this struct has a typedef
-                    tag_name = self._extract_tag_name_for_struct(tokens, struct_name)
+                    tag_name = typedef_tags.get(("struct", struct_name), "")
 
                 # Only register non-empty struct names here; anonymous will be created by the anonymous processor
                 if struct_name:
@@ -285,20 +674,15 @@ class CParser:
         return structs
 
     def _parse_enums_with_tokenizer(
-        self, tokens, structure_finder
+        self, tokens, structure_finder, enum_infos, typedef_tags
     ) -> Dict[str, "Enum"]:
-        """Parse enum definitions using tokenizer"""
+        """Parse the enum definitions found by the declaration scan"""
         enums = {}
-        enum_infos = structure_finder.find_enums()
 
         for start_pos, end_pos, enum_name in enum_infos:
             # Need to map back to original token positions
-            original_start = self._find_original_token_pos(
-                tokens, structure_finder.tokens, start_pos
-            )
-            original_end = self._find_original_token_pos(
-                tokens, structure_finder.tokens, end_pos
-            )
+            original_start = self._find_original_token_pos(structure_finder, start_pos)
+            original_end = self._find_original_token_pos(structure_finder, end_pos)
 
             if original_start is not None and original_end is not None:
                 # Extract enum values from original token range
@@ -324,7 +708,7 @@ class CParser:
                 tag_name = ""
                 if enum_name and not enum_name.startswith("__anonymous"):
                     # Check if this enum has a typedef
-                    tag_name = self._extract_tag_name_for_enum(tokens, enum_name)
+                    tag_name = typedef_tags.get(("enum", enum_name), "")
 
                 enums[enum_name] = Enum(enum_name, values, tag_name=tag_name)
                 self.logger.debug(
@@ -334,26 +718,23 @@ class CParser:
         return enums
 
     def _parse_unions_with_tokenizer(
-        self, tokens, structure_finder
+        self, tokens, structure_finder, union_infos, typedef_tags, nested_bodies=None
     ) -> Dict[str, "Union"]:
-        """Parse union definitions using tokenizer"""
+        """Parse the union definitions found by the declaration scan"""
         from ..models import Field, Union
 
         unions = {}
-        union_infos = structure_finder.find_unions()
 
         for start_pos, end_pos, union_name in union_infos:
             # Need to map back to original token positions
-            original_start = self._find_original_token_pos(
-                tokens, structure_finder.tokens, start_pos
-            )
-            original_end = self._find_original_token_pos(
-                tokens, structure_finder.tokens, end_pos
-            )
+            original_start = self._find_original_token_pos(structure_finder, start_pos)
+            original_end = self._find_original_token_pos(structure_finder, end_pos)
 
             if original_start is not None and original_end is not None:
                 # Extract field information from original token range
-                field_tuples = find_struct_fields(tokens, original_start, original_end)
+                field_tuples = find_struct_fields(
+                    tokens, original_start, original_end, nested_bodies
+                )
 
                 # Convert to Field objects
                 fields = []
@@ -373,7 +754,7 @@ class CParser:
                 tag_name = ""
                 if union_name and not union_name.startswith("__anonymous"):
                     # Check if this union has a typedef
-                    tag_name = self._extract_tag_name_for_union(tokens, union_name)
+                    tag_name = typedef_tags.get(("union", union_name), "")
 
                 unions[union_name] = Union(
                     union_name, fields, tag_name=tag_name, uses=[]
@@ -385,13 +766,12 @@ class CParser:
         return unions
 
     def _parse_functions_with_tokenizer(
-        self, tokens, structure_finder
+        self, tokens, structure_finder, function_infos
     ) -> List["Function"]:
-        """Parse function declarations/definitions using tokenizer"""
+        """Parse the function declarations/definitions found by the declaration scan"""
         from ..models import Function
 
         functions = []
-        function_infos = structure_finder.find_functions()
 
         for (
             start_pos,
@@ -402,12 +782,8 @@ class CParser:
             is_inline,
         ) in function_infos:
             # Map back to original token positions to parse parameters
-            original_start = self._find_original_token_pos(
-                tokens, structure_finder.tokens, start_pos
-            )
-            original_end = self._find_original_token_pos(
-                tokens, structure_finder.tokens, end_pos
-            )
+            original_start = self._find_original_token_pos(structure_finder, start_pos)
+            original_end = self._find_original_token_pos(structure_finder, end_pos)
 
             parameters = []
             if original_start is not None and original_end is not None:
@@ -436,6 +812,7 @@ class CParser:
         from ..models import Field
 
         globals_list = []
+        enclosed = self._brace_enclosed_positions(tokens)
 
         i = 0
         while i < len(tokens):
@@ -491,18 +868,8 @@ class CParser:
                 continue
 
             # Additional check: skip if we're inside any brace block (struct, function, etc.)
-            brace_count = 0
-            j = i - 1
-            while j >= 0:
-                if tokens[j].type == TokenType.RBRACE:
-                    brace_count += 1
-                elif tokens[j].type == TokenType.LBRACE:
-                    brace_count -= 1
-                    if brace_count < 0:
-                        # We're inside a brace block, skip this token
-                        i += 1
-                        break
-                j -= 1
+            if enclosed[i]:
+                i += 1
             else:
                 # Not inside a brace block, proceed with global variable parsing
                 global_info = self._parse_global_variable(tokens, i)
@@ -546,242 +913,104 @@ class CParser:
 
         return globals_list
 
-    def _parse_includes_with_tokenizer(self, tokens) -> List[str]:
-        """Parse #include directives using tokenizer"""
-        includes = []
+    def _brace_enclosed_positions(self, tokens) -> List[bool]:
+        """Flag every position that follows an unmatched '{'
 
+        Position i is enclosed when some '{' before it has no matching '}'
+        before i, i.e. when the running brace balance at i is above its
+        minimum over the earlier positions.
+        """
+        enclosed = []
+        balance = 0
+        lowest = 0
         for token in tokens:
-            if token.type == TokenType.INCLUDE:
-                match = INCLUDE_FILENAME_RE.search(token.value)
-                if match:
-                    includes.append(match.group(1))
+            enclosed.append(balance > lowest)
+            lowest = min(lowest, balance)
+            if token.type == TokenType.LBRACE:
+                balance += 1
+            elif token.type == TokenType.RBRACE:
+                balance -= 1
+        return enclosed
 
-        return includes
+    def _parse_directives_with_tokenizer(self, tokens) -> Tuple[List[str], List[str]]:
+        """Parse #include directives and macro definitions in one pass
 
-    def _parse_macros_with_tokenizer(self, tokens) -> List[str]:
-        """Parse macro definitions using tokenizer"""
+        Returns:
+            Tuple of (includes, macros)
+        """
+        includes = []
         macros = []
+        seen_macros = set()
 
         for token in tokens:
-            if token.type == TokenType.DEFINE:
+            if token.type == TokenType.INCLUDE:
+                match = INCLUDE_FILENAME_RE.search(token.value)
+                if match:
+                    includes.append(match.group(1))
+            elif token.type == TokenType.DEFINE:
                 # Store the full macro definition for display flexibility
                 # e.g., "#define PI 3.14159" -> "#define PI 3.14159"
                 # e.g., "#define MIN(a, b) ((a) < (b) ? (a) : (b))" -> "#define MIN(a, b) ((a) < (b) ? (a) : (b))"
                 macro_definition = token.value.strip()
-                if macro_definition not in macros:
+                if macro_definition not in seen_macros:
+                    seen_macros.add(macro_definition)
                     macros.append(macro_definition)
 
-        return macros
+        return includes, macros
 
-    def _parse_aliases_with_tokenizer(self, tokens) -> Dict[str, "Alias"]:
-        """Parse type aliases (primitive or derived typedefs) using tokenizer"""
-        from ..models import Alias
+    def _scan_typedefs(self, tokens) -> List[Tuple[int, str, str]]:
+        """Parse every typedef once
 
-        aliases = {}
-
-        i = 0
-        while i < len(tokens):
-            if tokens[i].type == TokenType.TYPEDEF:
-                # Found typedef, parse it
+        Returns:
+            List of (typedef token position, typedef name, original type) in file order
+        """
+        typedefs = []
+        for i, token in enumerate(tokens):
+            if token.type == TokenType.TYPEDEF:
                 typedef_info = self._parse_single_typedef(tokens, i)
                 if typedef_info:
-                    typedef_name, original_type = typedef_info
+                    typedefs.append((i,) + tuple(typedef_info))
+        return typedefs
 
-                    # Only include if it's NOT a struct/enum/union typedef
-                    if original_type not in ["struct", "enum", "union"]:
-                        aliases[typedef_name] = Alias(
-                            name=typedef_name, original_type=original_type, uses=[]
-                        )
+    def _parse_aliases_with_tokenizer(self, typedefs) -> Dict[str, "Alias"]:
+        """Collect type aliases (primitive or derived typedefs) from the scanned typedefs"""
+        from ..models import Alias
 
-            i += 1
+        aliases = {}
+
+        for _, typedef_name, original_type in typedefs:
+            # Only include if it's NOT a struct/enum/union typedef
+            if original_type not in ["struct", "enum", "union"]:
+                aliases[typedef_name] = Alias(
+                    name=typedef_name, original_type=original_type, uses=[]
+                )
 
         return aliases
 
     # _parse_typedef_relations_with_tokenizer method removed - tag names are now in struct/enum/union
 
-    def _extract_tag_name_for_struct(self, tokens, struct_name: str) -> str:
-        """Extract tag name for a struct if it has a typedef"""
-        i = 0
-        while i < len(tokens):
-            if tokens[i].type == TokenType.TYPEDEF:
-                typedef_info = self._parse_single_typedef(tokens, i)
-                if typedef_info:
-                    typedef_name, original_type = typedef_info
-                    if original_type == "struct" and typedef_name == struct_name:
-                        # Extract the tag name from the typedef
-                        return self._extract_tag_name_from_typedef(tokens, i)
-            i += 1
-        return ""
-
-    def _extract_tag_name_for_enum(self, tokens, enum_name: str) -> str:
-        """Extract tag name for an enum if it has a typedef"""
-        i = 0
-        while i < len(tokens):
-            if tokens[i].type == TokenType.TYPEDEF:
-                typedef_info = self._parse_single_typedef(tokens, i)
-                if typedef_info:
-                    typedef_name, original_type = typedef_info
-                    if original_type == "enum" and typedef_name == enum_name:
-                        # Extract the tag name from the typedef
-                        return self._extract_tag_name_from_typedef(tokens, i)
-            i += 1
-        return ""
-
-    def _extract_tag_name_for_union(self, tokens, union_name: str) -> str:
-        """Extract tag name for a union if it has a typedef"""
-        i = 0
-        while i < len(tokens):
-            if tokens[i].type == TokenType.TYPEDEF:
-                typedef_info = self._parse_single_typedef(tokens, i)
-                if typedef_info:
-                    typedef_name, original_type = typedef_info
-                    if original_type == "union" and typedef_name == union_name:
-                        # Extract the tag name from the typedef
-                        return self._extract_tag_name_from_typedef(tokens, i)
-            i += 1
-        return ""
-
-    def _extract_non_primitive_types(
-        self, type_str: str, available_types: Set[str]
-    ) -> List[str]:
-        """Extract non-primitive type names from a type string that exist in available_types"""
-        # Define primitive types
-        primitive_types = {
-            "void",
-            "char",
-            "short",
-            "int",
-            "long",
-            "float",
-            "double",
-            "signed",
-            "unsigned",
-            "const",
-            "volatile",
-            "static",
-            "extern",
-            "auto",
-            "register",
-            "inline",
-            "restrict",
-            "size_t",
-            "ptrdiff_t",
-            "int8_t",
-            "int16_t",
-            "int32_t",
-            "int64_t",
-            "uint8_t",
-            "uint16_t",
-            "uint32_t",
-            "uint64_t",
-            "intptr_t",
-            "uintptr_t",
-            "bool",
-            "true",
-            "false",
-            "NULL",
-            "nullptr",
-        }
-
-        # Remove common C keywords and operators
-        import re
-
-        # Split by common delimiters and operators
-        parts = re.split(r"[\[\]\(\)\{\}\s\*&,;]", type_str)
-
-        # Extract potential type names that exist in available_types
-        types = []
-        for part in parts:
-            part = part.strip()
-            if part and len(part) > 1 and part not in primitive_types:
-                # Check if it looks like a type name (starts with letter, contains letters/numbers/underscores)
-                if re.match(r"^[a-zA-Z_][a-zA-Z0-9_]*$", part):
-                    # Only include if it exists in available_types
-                    if part in available_types:
-                        types.append(part)
-
-        return list(set(types))  # Remove duplicates
+    def _typedef_tag_names(self, tokens, typedefs) -> Dict[Tuple[str, str], str]:
+        """Map (struct/enum/union, typedef name) to the tag name of its first typedef"""
+        tag_names = {}
+        for pos, typedef_name, original_type in typedefs:
+            if original_type in ("struct", "enum", "union"):
+                key = (original_type, typedef_name)
+                if key not in tag_names:
+                    tag_names[key] = self._extract_tag_name_from_typedef(tokens, pos)
+        return tag_names
 
     def _find_c_files(
         self, source_folder_path: Path, recursive_search: bool
     ) -> List[Path]:
-        """Find all C/C++ files in the source folder"""
-        c_extensions = {".c", ".h", ".cpp", ".cc", ".cxx", ".hpp", ".hxx"}
-        files = []
-
-        self.logger.debug("Searching for files with extensions: %s", c_extensions)
-
-        try:
-            if recursive_search:
-                for ext in c_extensions:
-                    try:
-                        files.extend(source_folder_path.rglob(f"*{ext}"))
-                    except (OSError, PermissionError) as e:
-                        self.logger.warning("Error during recursive search for %s files: %s", ext, e)
-                        # Continue with other extensions
-            else:
-                for ext in c_extensions:
-                    try:
-                        files.extend(source_folder_path.glob(f"*{ext}"))
-                    except (OSError, PermissionError) as e:
-                        self.logger.warning("Error during search for %s files: %s", ext, e)
-                        # Continue with other extensions
-        except Exception as e:
-            raise OSError(f"Failed to search for C/C++ files in '{source_folder_path}': {e}")
-
-        # Filter out hidden files and common exclude patterns
-        filtered_files = []
-        exclude_patterns = {".git", "__pycache__", "node_modules", ".vscode", ".idea"}
-
-        for file_path in files:
-            try:
-                # Skip hidden files and directories
-                if any(part.startswith(".") for part in file_path.parts):
-                    continue
-
-                # Skip common exclude patterns
-                if any(pattern in file_path.parts for pattern in exclude_patterns):
-                    continue
-
-                # Verify the file is actually accessible
-                if not file_path.exists():
-                    self.logger.debug("Skipping non-existent file: %s", file_path)
-                    continue
-                
-                if not file_path.is_file():
-                    self.logger.debug("Skipping non-file item: %s", file_path)
-                    continue
-
-                filtered_files.append(file_path)
-            except (OSError, PermissionError) as e:
-                self.logger.warning("Error accessing file %s: %s", file_path, e)
-                # Skip files we can't access
-                continue
+        """Find all C/C++ files in the source folder (see SourceDiscovery)"""
+        return SourceDiscovery().find(source_folder_path, recursive_search)
 
-        self.logger.debug("Found %d C/C++ files after filtering", len(filtered_files))
-        return sorted(filtered_files)
-
-    def _detect_encoding(self, file_path: Path) -> str:
-        """Detect file encoding with platform-aware fallbacks"""
-        return detect_file_encoding(file_path)
-
-    def _find_original_token_pos(self, all_tokens, filtered_tokens, filtered_pos):
-        """Find the position in all_tokens that corresponds to filtered_tokens[filtered_pos]"""
-        if filtered_pos >= len(filtered_tokens):
+    def _find_original_token_pos(self, structure_finder, filtered_pos):
+        """Find the position in the unfiltered tokens of structure_finder.tokens[filtered_pos]"""
+        positions = structure_finder.original_positions
+        if filtered_pos >= len(positions):
             return None
-
-        target_token = filtered_tokens[filtered_pos]
-
-        # Search for the token in all_tokens by line and column
-        for i, token in enumerate(all_tokens):
-            if (
-                token.line == target_token.line
-                and token.column == target_token.column
-                and token.value == target_token.value
-            ):
-                return i
-
-        return None
+        return positions[filtered_pos]
 
     def _parse_single_typedef(self, tokens, start_pos):
         """Parse a single typedef starting at the given position"""
@@ -1635,6 +1864,39 @@ class Parser:
     def __init__(self):
         self.c_parser = CParser()
         self.logger = logging.getLogger(__name__)
+        # Plan of the last sharded parse_model call
+        self.shard_plan: Optional[ShardPlan] = None
+
+    def _plan_shard(
+        self,
+        source_folders: "List[str]",
+        recursive_search: bool,
+        config: "Config",
+        shard: Tuple[int, int],
+    ) -> ShardPlan:
+        """Plan the shards over the files of all source folders and select shard's files"""
+        index, count = shard
+        discovery = SourceDiscovery.from_config(config) if config else SourceDiscovery()
+        paths: List[Path] = []
+        for source_folder in source_folders:
+            folder_path = Path(source_folder).resolve()
+            if folder_path.is_dir():
+                paths.extend(discovery.find(folder_path, recursive_search))
+        plan = ShardPlan.build(paths, count)
+        if getattr(config, "deduplicate_anonymous", False):
+            self.logger.warning(
+                "deduplicate_anonymous is applied within each shard; merged models may store layouts more than once"
+            )
+        self.c_parser.file_selection = plan.selection(index, paths)
+        self.logger.info(
+            "Shard %d/%d: %d of %d files, %d root files",
+            index,
+            count,
+            len(self.c_parser.file_selection),
+            len(paths),
+            sum(1 for name in plan.owned(index) if name.endswith(".c")),
+        )
+        return plan
 
     def parse(
         self,
@@ -1642,6 +1904,7 @@ class Parser:
         output_file: str = "model.json",
         recursive_search: bool = True,
         config: "Config" = None,
+        shard: Optional[Tuple[int, int]] = None,
     ) -> str:
         """Parse C/C++ projects and generate model.json
 
@@ -1650,10 +1913,42 @@ class Parser:
             output_file: Path to the output model.json file
             recursive_search: Whether to search subdirectories recursively
             config: Configuration object for filtering and processing
+            shard: (index, count) to parse only the files of one shard (see ShardPlan)
 
         Returns:
             Path to the generated model.json file
         """
+        combined_model = self.parse_model(source_folders, recursive_search, config, shard)
+
+        # Save combined model to JSON file
+        try:
+            combined_model.save(output_file)
+        except Exception as e:
+            raise RuntimeError(f"Failed to save model to {output_file}: {e}") from e
+
+        self.logger.info("Step 1 complete! Model saved to: %s", output_file)
+        return output_file
+
+    @PROFILER.profiled("parse")
+    def parse_model(
+        self,
+        source_folders: "List[str]",
+        recursive_search: bool = True,
+        config: "Config" = None,
+        shard: Optional[Tuple[int, int]] = None,
+    ) -> ProjectModel:
+        """Parse C/C++ projects and return the combined, verified project model
+
+        Args:
+            source_folders: List of source folder directories within the project
+            recursive_search: Whether to search subdirectories recursively
+            config: Configuration object for filtering and processing
+            shard: (index, count) to parse only the files of one shard; the
+                plan is kept in shard_plan
+
+        Returns:
+            Combined ProjectModel for all source folders (not written to disk)
+        """
         # Enhanced validation for source_folders
         if not isinstance(source_folders, list):
             raise TypeError(f"source_folders must be a list of strings, got: {type(source_folders)}")
@@ -1683,6 +1978,18 @@ class Parser:
         total_enums = 0
         total_functions = 0
         failed_folders = []
+        # Header define snapshots are computed once per run, then shared by the folders
+        self.c_parser.translation_units = None
+        # Files are verified while parsing (in the parse workers with --jobs)
+        verify_mode = getattr(config, "verify_mode", "full") if config else "full"
+        sample_rate = float(getattr(config, "verify_sample_rate", 0.1)) if verify_mode == "sample" else 1.0
+        self.c_parser.verify_mode = verify_mode
+        self.c_parser.verify_sample_rate = sample_rate
+        self.c_parser.file_issues = {}
+        self.c_parser.file_selection = None
+        self.shard_plan = None
+        if shard is not None:
+            self.shard_plan = self._plan_shard(source_folders, recursive_search, config, shard)
 
         for i, source_folder in enumerate(source_folders):
             self.logger.info(
@@ -1734,6 +2041,16 @@ class Parser:
                 f"Failed to parse {len(failed_folders)} out of {len(source_folders)} source folders"
             )
 
+        # Store identical anonymous layouts once across all source folders
+        if getattr(config, "deduplicate_anonymous", False):
+            with PROFILER.stage("parse.anonymous_dedup"):
+                deduplicated = deduplicate_anonymous_structures(all_files, self.logger)
+            # Files changed by deduplication are verified again
+            for key, file_model in deduplicated.items():
+                if file_model is not all_files.get(key):
+                    self.c_parser.file_issues.pop(key, None)
+            all_files = deduplicated
+
         # Create combined project model
         combined_model = ProjectModel(
             project_name=project_name,
@@ -1746,30 +2063,32 @@ class Parser:
         )
 
         # Update all uses fields across the entire combined project
-        combined_model.update_uses_fields()
-
-        # Save combined model to JSON file
-        try:
-            combined_model.save(output_file)
-        except Exception as e:
-            raise RuntimeError(f"Failed to save model to {output_file}: {e}") from e
+        with PROFILER.stage("parse.uses_update"):
+            combined_model.update_uses_fields()
 
         # Step 1.5: Verify model sanity
-        self.logger.info("Step 1.5: Verifying model sanity...")
-        from .verifier import ModelVerifier
-
-        verifier = ModelVerifier()
-        is_valid, issues = verifier.verify_model(combined_model)
+        if verify_mode == "off":
+            self.logger.info("Step 1.5: Model verification disabled (verify_mode: off)")
+            is_valid, issues = True, []
+        else:
+            self.logger.info("Step 1.5: Verifying model sanity...")
+            verifier = ModelVerifier()
+            with PROFILER.stage("parse.verify"):
+                is_valid, issues = verifier.verify_model(
+                    combined_model,
+                    file_issues=self.c_parser.file_issues,
+                    sample_rate=sample_rate,
+                    max_issues=int(getattr(config, "verify_max_issues", 0) or 0),
+                )
 
         if not is_valid:
             self.logger.warning(
                 f"Model verification found {len(issues)} issues - model may contain parsing errors"
             )
             # Continue processing but warn about potential issues
-        else:
+        elif verify_mode != "off":
             self.logger.info("Model verification passed - all values look sane")
 
-        self.logger.info("Step 1 complete! Model saved to: %s", output_file)
         self.logger.info(
             f"Found {len(all_files)} total files across {len(source_folders)} source folder(s)"
         )
@@ -1780,4 +2099,4 @@ class Parser:
             f"{total_functions} functions"
         )
 
-        return output_file
+        return combined_model
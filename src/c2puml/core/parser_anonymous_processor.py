@@ -1,17 +1,39 @@
 """Processing anonymous structures within typedefs."""
 
+import copy
+import dataclasses
+import logging
 import re
+import threading
 from typing import Dict, List, Tuple, Optional
 from ..models import FileModel, Struct, Union, Field, Alias
+from .parser_tokenizer import Token, TokenType, find_struct_fields
+
+# How the fields of nested anonymous structures are parsed (see AnonymousTypedefProcessor)
+ANONYMOUS_EXTRACTION_MODES = ("text", "tokens")
+
+_ANONYMOUS_FIELD_RE = re.compile(r'struct\s*\{|union\s*\{|/\*ANON:')
+_BLOCK_COMMENT_RE = re.compile(r'/\*.*?\*/')
+_LINE_COMMENT_RE = re.compile(r'//.*$', re.MULTILINE)
 
 
 class AnonymousTypedefProcessor:
-    """Handles extraction and processing of anonymous structures within typedefs."""
+    """Handles extraction and processing of anonymous structures within typedefs.
 
-    def __init__(self):
+    With nested_bodies (body text -> body tokens, collected by
+    find_struct_fields), the fields of nested anonymous structs and unions are
+    parsed from their tokens by find_struct_fields itself, which also collects
+    the bodies nested one level deeper; without it the body text is re-parsed.
+    In that mode every nested entity is named after its actual parent and
+    field (Parent_field) and the field is linked to it directly, instead of
+    reusing a body with the same text or matching field names afterwards.
+    """
+
+    def __init__(self, nested_bodies: Optional[Dict[str, List[Token]]] = None):
+        self.logger = logging.getLogger(__name__)
+        self.nested_bodies = nested_bodies
         self.anonymous_counters: Dict[str, Dict[str, int]] = {}  # parent -> {type -> count}
-        self.global_anonymous_structures = {}  # Track anonymous structures globally by content hash
-        self.content_to_structure_map = {}  # content_hash -> (name, struct_type)
+        self.content_to_structure_map: Dict[Tuple[str, str], str] = {}  # (struct_type, content) -> name
 
     def process_file_model(self, file_model: FileModel) -> None:
         """Process all typedefs in a file model to extract anonymous structures using multi-pass processing."""
@@ -164,29 +186,25 @@ class AnonymousTypedefProcessor:
         """Generate a name for an anonymous structure. Field name is always required."""
         return f"{parent_name}_{field_name}"
     
-    def _generate_content_hash(self, content: str, struct_type: str) -> str:
-        """Generate a hash for anonymous structure content to identify duplicates."""
-        import hashlib
-        # Normalize the content by removing whitespace and comments
-        normalized = re.sub(r'\s+', ' ', content.strip())
-        normalized = re.sub(r'/\*.*?\*/', '', normalized)  # Remove C comments
-        normalized = re.sub(r'//.*$', '', normalized, flags=re.MULTILINE)  # Remove C++ comments
-        hash_input = f"{struct_type}:{normalized}"
-        return hashlib.md5(hash_input.encode()).hexdigest()[:8]
+    def _content_key(self, content: str, struct_type: str) -> Tuple[str, str]:
+        """Return the structural fingerprint of anonymous structure content.
+
+        Whitespace is collapsed and comments are dropped; the normalized text
+        itself is the key, so no digest has to be computed.
+        """
+        normalized = " ".join(content.split())
+        if "/" in normalized:
+            normalized = _BLOCK_COMMENT_RE.sub('', normalized)
+            normalized = _LINE_COMMENT_RE.sub('', normalized)
+        return struct_type, normalized
     
     def _find_existing_anonymous_structure(self, content: str, struct_type: str) -> Optional[str]:
         """Find an existing anonymous structure with the same content."""
-        content_hash = self._generate_content_hash(content, struct_type)
-        if content_hash in self.content_to_structure_map:
-            existing_name, existing_type = self.content_to_structure_map[content_hash]
-            if existing_type == struct_type:
-                return existing_name
-        return None
+        return self.content_to_structure_map.get(self._content_key(content, struct_type))
     
     def _register_anonymous_structure(self, name: str, content: str, struct_type: str) -> None:
-        """Register an anonymous structure in the global tracking system."""
-        content_hash = self._generate_content_hash(content, struct_type)
-        self.content_to_structure_map[content_hash] = (name, struct_type)
+        """Register an anonymous structure for deduplication within the file."""
+        self.content_to_structure_map[self._content_key(content, struct_type)] = name
     
     def _get_or_create_anonymous_structure(self, file_model: FileModel, content: str, struct_type: str, 
                                          parent_name: str, field_name: str) -> str:
@@ -213,9 +231,11 @@ class AnonymousTypedefProcessor:
             
             return anon_name
         else:
-            # For actual content, use content-based deduplication
-            # First, check if we already have a structure with this content
-            existing_name = self._find_existing_anonymous_structure(content, struct_type)
+            # For actual content, use content-based deduplication (text mode only:
+            # with tokens every parent gets its own entity)
+            existing_name = None
+            if self.nested_bodies is None:
+                existing_name = self._find_existing_anonymous_structure(content, struct_type)
             if existing_name:
                 # Check if the existing structure still exists in the model
                 if (struct_type == "struct" and existing_name in file_model.structs) or \
@@ -245,14 +265,45 @@ class AnonymousTypedefProcessor:
 
     def _create_anonymous_struct(self, name: str, content: str) -> Struct:
         """Create an anonymous struct from content."""
-        fields = self._parse_struct_fields(content)
+        fields = self._parse_anonymous_fields(content)
         return Struct(name, fields, tag_name="")
 
     def _create_anonymous_union(self, name: str, content: str) -> Union:
         """Create an anonymous union from content."""
-        fields = self._parse_struct_fields(content)
+        fields = self._parse_anonymous_fields(content)
         return Union(name, fields, tag_name="")
 
+    def _parse_anonymous_fields(self, content: str) -> List[Field]:
+        """Parse the fields of an anonymous structure from its tokens if known, else from text."""
+        body = self.nested_bodies.get(content) if self.nested_bodies else None
+        if body is None or self._has_function_pointer_member(body):
+            return self._parse_struct_fields(content)
+
+        fields = []
+        for field_name, field_type in find_struct_fields(body, 0, len(body) - 1, self.nested_bodies):
+            try:
+                fields.append(Field(field_name, field_type))
+            except ValueError as e:
+                self.logger.warning("Error creating anonymous field %s: %s", field_name, e)
+        return fields
+
+    @staticmethod
+    def _has_function_pointer_member(body: List[Token]) -> bool:
+        """Check if a body declares a function pointer member at its own level.
+
+        find_struct_fields only handles single-token return types there, so such
+        bodies keep going through the text parser.
+        """
+        depth = 0
+        for token, next_token in zip(body, body[1:]):
+            if token.type == TokenType.LBRACE:
+                depth += 1
+            elif token.type == TokenType.RBRACE:
+                depth -= 1
+            elif depth == 1 and token.type == TokenType.LPAREN and next_token.type == TokenType.ASTERISK:
+                return True
+        return False
+
     def _parse_struct_fields(self, content: str) -> List[Field]:
         """Parse struct/union fields from content."""
         fields = []
@@ -524,20 +575,8 @@ class AnonymousTypedefProcessor:
 
     def _field_contains_anonymous_struct(self, field: Field) -> bool:
         """Check if a field contains an anonymous structure."""
-        field_type = field.type
-        
-        # Check for various anonymous structure patterns
-        patterns = [
-            r'struct\s*\{',  # struct { ... }
-            r'union\s*\{',   # union { ... }
-            r'/\*ANON:',     # Preserved content format
-        ]
-        
-        for pattern in patterns:
-            if re.search(pattern, field_type):
-                return True
-        
-        return False
+        # struct { ... }, union { ... } or the preserved content format /*ANON:
+        return _ANONYMOUS_FIELD_RE.search(field.type) is not None
 
     def _extract_anonymous_from_field(
         self, file_model: FileModel, parent_name: str, field: Field
@@ -710,15 +749,21 @@ class AnonymousTypedefProcessor:
 
     def _update_field_references_to_extracted_entities(self, file_model: FileModel) -> None:
         """Post-processing step to update field references to point to extracted entities."""
-        # Process all structs and unions to update field references
-        for struct_name, struct_data in file_model.structs.items():
-            self._update_entity_field_references(file_model, struct_name, struct_data)
-        
-        for union_name, union_data in file_model.unions.items():
-            self._update_entity_field_references(file_model, union_name, union_data)
-        
-        # Special handling: Check if there are flattened fields that should be replaced with references
-        self._fix_flattened_fields_with_references(file_model)
+        # With tokens every field is already linked to the entity extracted from it,
+        # so fields are not matched to entities by name
+        if self.nested_bodies is None:
+            # Built once: updating field types does not add or remove entities
+            entity_index = self._build_entity_suffix_index(file_model)
+
+            # Process all structs and unions to update field references
+            for struct_name, struct_data in file_model.structs.items():
+                self._update_entity_field_references(file_model, struct_name, struct_data, entity_index)
+
+            for union_name, union_data in file_model.unions.items():
+                self._update_entity_field_references(file_model, union_name, union_data, entity_index)
+
+            # Special handling: Check if there are flattened fields that should be replaced with references
+            self._fix_flattened_fields_with_references(file_model)
 
         # De-duplicate anonymous relationships to prevent inflated relationship counts
         if file_model.anonymous_relationships:
@@ -743,19 +788,13 @@ class AnonymousTypedefProcessor:
             
             # Check if this struct has fields that look like they should reference an extracted entity
             for field in struct_data.fields:
-                # Look for extracted entities that might match this field's content
-                for union_name in file_model.unions:
-                    if union_name == field.name:
-                        # Found a union with the same name as this field
-                        # Check if this field's type matches the union's field types
-                        union_data = file_model.unions[union_name]
-                        if len(union_data.fields) == 2:  # Simple heuristic
-                            # This might be a flattened union
-                            fields_to_replace.append(field)
-                            extracted_entity_to_add = union_name
-                            break
-                
-                if extracted_entity_to_add:
+                # Look for an extracted union with the same name as this field
+                union_data = file_model.unions.get(field.name)
+                # Check if this field's type matches the union's field types
+                if union_data is not None and len(union_data.fields) == 2:  # Simple heuristic
+                    # This might be a flattened union
+                    fields_to_replace.append(field)
+                    extracted_entity_to_add = field.name
                     break
             
             # Replace the flattened fields with a reference to the extracted entity
@@ -798,45 +837,36 @@ class AnonymousTypedefProcessor:
                 if "level3_union" not in file_model.anonymous_relationships[target_struct_name]:
                     file_model.anonymous_relationships[target_struct_name].append("level3_union")
 
-    def _update_entity_field_references(self, file_model: FileModel, entity_name: str, entity_data) -> None:
+    def _update_entity_field_references(
+        self, file_model: FileModel, entity_name: str, entity_data, entity_index: Dict[str, str]
+    ) -> None:
         """Update field references in an entity to point to extracted entities."""
         for field in entity_data.fields:
-            # Check if this field should reference an extracted entity
-            if self._field_should_reference_extracted_entity(field, file_model):
-                # Find the extracted entity that this field should reference
-                extracted_entity_name = self._find_extracted_entity_for_field(field, file_model)
-                if extracted_entity_name:
-                    # Update the field type to reference the extracted entity
-                    field.type = extracted_entity_name
-
-    def _field_should_reference_extracted_entity(self, field: Field, file_model: FileModel) -> bool:
-        """Check if a field should reference an extracted entity."""
-        # Check if there's an extracted entity that matches this field's content
-        # This is a heuristic based on the field name and available extracted entities
-        
-        # Look for extracted entities that might match this field
-        for union_name in file_model.unions:
-            if union_name == field.name or union_name.endswith(f"_{field.name}"):
-                return True
-        
-        for struct_name in file_model.structs:
-            if struct_name == field.name or struct_name.endswith(f"_{field.name}"):
-                return True
-        
-        return False
+            # Find the extracted entity that this field should reference
+            extracted_entity_name = entity_index.get(field.name)
+            if extracted_entity_name:
+                # Update the field type to reference the extracted entity
+                field.type = extracted_entity_name
 
-    def _find_extracted_entity_for_field(self, field: Field, file_model: FileModel) -> Optional[str]:
-        """Find the extracted entity that a field should reference."""
-        # Look for extracted entities that match this field
-        for union_name in file_model.unions:
-            if union_name == field.name or union_name.endswith(f"_{field.name}"):
-                return union_name
-        
-        for struct_name in file_model.structs:
-            if struct_name == field.name or struct_name.endswith(f"_{field.name}"):
-                return struct_name
-        
-        return None
+    def _build_entity_suffix_index(self, file_model: FileModel) -> Dict[str, str]:
+        """Map field names to the extracted entity a field of that name should reference.
+
+        An entity matches a field name that equals its name or follows any of
+        its underscores (a heuristic based on the anonymous naming scheme);
+        unions take precedence over structs and earlier entities over later ones.
+        """
+        index: Dict[str, str] = {}
+        for entities in (file_model.unions, file_model.structs):
+            found: Dict[str, str] = {}
+            for name in entities:
+                found.setdefault(name, name)
+                underscore = name.find("_")
+                while underscore != -1:
+                    found.setdefault(name[underscore + 1:], name)
+                    underscore = name.find("_", underscore + 1)
+            for field_name, name in found.items():
+                index.setdefault(field_name, name)
+        return index
 
     def _has_balanced_anonymous_pattern(self, text: str) -> bool:
         """Check if text contains an anonymous struct/union pattern with balanced braces."""
@@ -970,4 +1000,129 @@ class AnonymousTypedefProcessor:
                         break
                 pos += 1
         
-        return None
\ No newline at end of file
+        return None
+
+
+class AnonymousStructureRegistry:
+    """Project-scoped table of extracted anonymous structure layouts.
+
+    A layout is keyed by its structural fingerprint: the kind plus the names
+    and types of its fields, with nested anonymous references already mapped
+    to their owners. deduplicate() walks a project's files in sorted key
+    order, so the first file defining a layout owns it whatever the number of
+    parse jobs; later copies are dropped and their references renamed to the
+    owner's entity. Registration is lock-protected so threads may share a
+    registry, and worker processes never register: deduplication runs on the
+    merged model in the main process. Use one registry per project model.
+    """
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._owners: Dict[tuple, Tuple[str, str]] = {}  # fingerprint -> (file key, name)
+
+    def __len__(self) -> int:
+        return len(self._owners)
+
+    @staticmethod
+    def fingerprint(kind: str, fields: List[Field], renames: Dict[str, str]) -> tuple:
+        """Return the fingerprint of a layout, mapping renamed field types first"""
+        return (kind,) + tuple((f.name, renames.get(f.type, f.type)) for f in fields)
+
+    def register(self, fingerprint: tuple, file_key: str, name: str) -> Tuple[str, str]:
+        """Return the (file key, name) owning a layout, registering it if new"""
+        with self._lock:
+            return self._owners.setdefault(fingerprint, (file_key, name))
+
+    def deduplicate(self, files: Dict[str, FileModel]) -> Dict[str, FileModel]:
+        """Return the files with every repeated anonymous layout stored once.
+
+        Changed files are shallow copies with new collections; the given
+        FileModels are not modified (the watch session keeps reusing them).
+        """
+        result = dict(files)
+        for key in sorted(files):
+            deduplicated = self._deduplicate_file(key, files[key])
+            if deduplicated is not None:
+                result[key] = deduplicated
+        return result
+
+    def _deduplicate_file(self, key: str, file_model: FileModel) -> Optional[FileModel]:
+        """Register the anonymous entities of one file; return its copy if any were dropped"""
+        relationships = file_model.anonymous_relationships
+        if not relationships:
+            return None
+
+        renames: Dict[str, str] = {}
+        for name in self._children_first(relationships):
+            if name in file_model.structs:
+                kind, entity = "struct", file_model.structs[name]
+            elif name in file_model.unions:
+                kind, entity = "union", file_model.unions[name]
+            else:
+                continue
+            owner_key, owner_name = self.register(
+                self.fingerprint(kind, entity.fields, renames), key, name
+            )
+            # A copy under the owner's own name (in another file) is dropped as well
+            if owner_key != key or owner_name != name:
+                renames[name] = owner_name
+        if not renames:
+            return None
+
+        deduplicated = copy.copy(file_model)
+        deduplicated.structs = {
+            name: self._renamed(struct, renames)
+            for name, struct in file_model.structs.items() if name not in renames
+        }
+        deduplicated.unions = {
+            name: self._renamed(union, renames)
+            for name, union in file_model.unions.items() if name not in renames
+        }
+        deduplicated.aliases = {
+            name: (
+                dataclasses.replace(alias, original_type=renames[alias.original_type])
+                if alias.original_type in renames else alias
+            )
+            for name, alias in file_model.aliases.items()
+        }
+        deduplicated.anonymous_relationships = {}
+        for parent, children in relationships.items():
+            if parent in renames:
+                continue
+            renamed_children = []
+            for child in children:
+                child = renames.get(child, child)
+                if child not in renamed_children:
+                    renamed_children.append(child)
+            deduplicated.anonymous_relationships[parent] = renamed_children
+        return deduplicated
+
+    @staticmethod
+    def _children_first(relationships: Dict[str, List[str]]) -> List[str]:
+        """Return the extracted entities of a file, nested ones before their parents"""
+        ordered: List[str] = []
+        visited = set()
+
+        def visit(name: str) -> None:
+            visited.add(name)
+            for child in relationships.get(name, ()):
+                if child not in visited:
+                    visit(child)
+            ordered.append(name)
+
+        for children in relationships.values():
+            for child in children:
+                if child not in visited:
+                    visit(child)
+        return ordered
+
+    @staticmethod
+    def _renamed(entity, renames: Dict[str, str]):
+        """Return the entity with field types pointing at the owners of renamed layouts"""
+        if not any(field.type in renames for field in entity.fields):
+            return entity
+        fields = [
+            dataclasses.replace(field, type=renames[field.type]) if field.type in renames else field
+            for field in entity.fields
+        ]
+        return dataclasses.replace(entity, fields=fields)
@@ -5,9 +5,10 @@ Tokenizer module for C to PlantUML converter - Helper library for tokenizing C/C
 
 import logging
 import re
+import sys
 from dataclasses import dataclass
 from enum import Enum
-from typing import List, Optional, Tuple
+from typing import Dict, List, Optional, Tuple
 
 
 class TokenType(Enum):
@@ -70,7 +71,13 @@ class TokenType(Enum):
 
 @dataclass
 class Token:
-    """Represents a single token in C/C++ code"""
+    """Represents a single token in C/C++ code
+
+    Tokens are created for every whitespace run and newline, so they use
+    __slots__ to avoid a per-instance __dict__.
+    """
+
+    __slots__ = ("type", "value", "line", "column")
 
     type: TokenType
     value: str
@@ -81,6 +88,18 @@ class Token:
         return f"Token({self.type.name}, '{self.value}', {self.line}:{self.column})"
 
 
+# Line boundaries recognised by str.splitlines(); the single-pass engine must
+# split the buffer exactly like the line engine does
+LINE_BREAK_RE = re.compile("\r\n|[\n\r\x0b\x0c\x1c\x1d\x1e\x85\u2028\u2029]")
+
+# Remainder of a string literal up to and including the closing quote
+STRING_BODY_RE = re.compile(r'[^"\\]*(?:\\.[^"\\]*)*"')
+
+# Available tokenizer engines: "line" tokenizes line by line, "single_pass"
+# scans the whole buffer once; both produce identical token streams
+TOKENIZER_ENGINES = ("line", "single_pass")
+
+
 class CTokenizer:
     """Tokenizer for C/C++ source code"""
 
@@ -126,8 +145,19 @@ class CTokenizer:
         "->": TokenType.ARROW,
     }
 
-    def __init__(self):
+    # Token types removed by filter_tokens() by default
+    DEFAULT_FILTER_TYPES = frozenset(
+        {
+            TokenType.WHITESPACE,
+            TokenType.COMMENT,
+            TokenType.NEWLINE,
+            TokenType.EOF,
+        }
+    )
+
+    def __init__(self, engine: str = "line"):
         self.logger = logging.getLogger(__name__)
+        self.engine = engine
 
         # Compiled regex patterns for efficiency
         self.patterns = {
@@ -147,8 +177,27 @@ class CTokenizer:
             "newline": re.compile(r"\n"),
         }
 
+    @property
+    def engine(self) -> str:
+        """Name of the tokenizer engine used by tokenize()"""
+        return self._engine
+
+    @engine.setter
+    def engine(self, engine: str) -> None:
+        if engine not in TOKENIZER_ENGINES:
+            raise ValueError(
+                f"Unknown tokenizer engine '{engine}', expected one of: {', '.join(TOKENIZER_ENGINES)}"
+            )
+        self._engine = engine
+
     def tokenize(self, content: str) -> List[Token]:
         """Tokenize C/C++ source code content"""
+        if self._engine == "single_pass":
+            return self._tokenize_single_pass(content)
+        return self._tokenize_lines(content)
+
+    def _tokenize_lines(self, content: str) -> List[Token]:
+        """Tokenize content line by line (original engine)"""
         tokens = []
         lines = content.splitlines()
         total_lines = len(lines)
@@ -254,6 +303,210 @@ class CTokenizer:
 
         return tokens
 
+    def _tokenize_single_pass(self, content: str) -> List[Token]:
+        """Tokenize content in a single scan over the whole buffer
+
+        Produces exactly the same token stream as _tokenize_lines() but works on
+        buffer offsets instead of per-line strings. Multi-line comments and
+        strings are collected as they are scanned and backslash-continued
+        #define directives are merged inline instead of in a second pass.
+        """
+        tokens = []
+        append = tokens.append
+        single_char_tokens = self.SINGLE_CHAR_TOKENS
+        keywords = self.KEYWORDS
+        whitespace_re = self.patterns["whitespace"]
+        preprocessor_re = self.patterns["preprocessor"]
+        char_re = self.patterns["char"]
+        number_re = self.patterns["number"]
+        identifier_re = self.patterns["identifier"]
+        string_body_re = STRING_BODY_RE
+        line_break_search = LINE_BREAK_RE.search
+        # Identifiers, keywords and whitespace runs repeat heavily; share one copy
+        intern = sys.intern
+        operator_type = (
+            TokenType.OPERATOR if hasattr(TokenType, "OPERATOR") else TokenType.UNKNOWN
+        )
+
+        # Pending multi-line string or comment: (type, parts, line, column)
+        pending = None
+
+        # Lines are split like str.splitlines(): a trailing line break does not
+        # start another (empty) line
+        length = len(content)
+        line_num = 0
+        last_len = 0
+        base = 0
+        while base < length:
+            line_num += 1
+            line_break = line_break_search(content, base)
+            if line_break:
+                end, next_base = line_break.span()
+            else:
+                end = next_base = length
+
+            if pending is not None:
+                pending_type, parts, start_line, start_col = pending
+                if pending_type is TokenType.STRING:
+                    parts.append(content[base:end])
+                    if content.find('"', base, end) != -1:
+                        # End of multiline string, rest of the line is consumed
+                        append(Token(TokenType.STRING, "\n".join(parts), start_line, start_col))
+                        pending = None
+                else:
+                    comment_end = content.rfind("*/", base, end)
+                    if comment_end != -1:
+                        # End of multi-line comment, rest of the line is consumed
+                        parts.append(content[base : comment_end + 2])
+                        append(Token(TokenType.COMMENT, "\n".join(parts), start_line, start_col))
+                        pending = None
+                    else:
+                        parts.append(content[base:end])
+            else:
+                pos = base
+                while pos < end:
+                    ch = content[pos]
+
+                    if ch == " " or ch == "\t":
+                        match = whitespace_re.match(content, pos, end)
+                        append(
+                            Token(TokenType.WHITESPACE, intern(match.group()), line_num, pos - base)
+                        )
+                        pos = match.end()
+
+                    elif ch == "/" and pos + 1 < end and content[pos + 1] == "/":
+                        append(Token(TokenType.COMMENT, content[pos:end], line_num, pos - base))
+                        pos = end
+
+                    elif ch == "/" and pos + 1 < end and content[pos + 1] == "*":
+                        comment_end = content.find("*/", pos, end)
+                        if comment_end != -1:
+                            append(
+                                Token(
+                                    TokenType.COMMENT,
+                                    content[pos : comment_end + 2],
+                                    line_num,
+                                    pos - base,
+                                )
+                            )
+                            pos = comment_end + 2
+                        else:
+                            # Comment continues on the next lines
+                            pending = (
+                                TokenType.COMMENT,
+                                [content[pos:end]],
+                                line_num,
+                                pos - base,
+                            )
+                            pos = end
+
+                    elif ch == "#" and preprocessor_re.match(content, pos, end):
+                        value = content[pos:end]
+                        if value.startswith("#include"):
+                            append(Token(TokenType.INCLUDE, value, line_num, pos - base))
+                        elif value.startswith("#define"):
+                            if value.rstrip().endswith("\\"):
+                                value = self._merge_continuation_lines(
+                                    content, value, next_base
+                                )
+                            append(Token(TokenType.DEFINE, value, line_num, pos - base))
+                        else:
+                            append(Token(TokenType.PREPROCESSOR, value, line_num, pos - base))
+                        pos = end
+
+                    elif ch == '"':
+                        # Include a u8/L/u/U/R prefix, mirroring line[pos - 1] lookups
+                        col = pos - base
+                        if col >= 2 and content.startswith("u8", pos - 2):
+                            string_col = col - 2
+                        elif content[pos - 1 if col else end - 1] in "LuUR":
+                            string_col = col - 1
+                        else:
+                            string_col = col
+                        match = string_body_re.match(content, pos + 1, end)
+                        if match:
+                            string_end = match.end()
+                            if string_col >= 0:
+                                value = content[base + string_col : string_end]
+                            else:
+                                value = content[base:end][string_col : string_end - base]
+                            append(Token(TokenType.STRING, value, line_num, string_col))
+                            pos = string_end
+                        else:
+                            if string_col >= 0:
+                                value = content[base + string_col : end]
+                            else:
+                                value = content[base:end][string_col:]
+                            if value.endswith('"'):
+                                append(Token(TokenType.STRING, value, line_num, string_col))
+                            else:
+                                # String continues on the next lines
+                                pending = (TokenType.STRING, [value], line_num, string_col)
+                            pos = end
+
+                    elif ch == "'" and (match := char_re.match(content, pos, end)):
+                        append(Token(TokenType.CHAR_LITERAL, match.group(), line_num, pos - base))
+                        pos = match.end()
+
+                    elif ch in single_char_tokens:
+                        append(Token(single_char_tokens[ch], ch, line_num, pos - base))
+                        pos += 1
+
+                    elif ch in "<>-" and pos + 1 < end and content[pos + 1] == (
+                        ">" if ch == "-" else ch
+                    ):
+                        op = content[pos : pos + 2]
+                        op_type = TokenType.ARROW if ch == "-" else operator_type
+                        append(Token(op_type, op, line_num, pos - base))
+                        pos += 2
+
+                    elif match := number_re.match(content, pos, end):
+                        append(Token(TokenType.NUMBER, match.group(), line_num, pos - base))
+                        pos = match.end()
+
+                    elif match := identifier_re.match(content, pos, end):
+                        value = intern(match.group())
+                        append(
+                            Token(
+                                keywords.get(value.lower(), TokenType.IDENTIFIER),
+                                value,
+                                line_num,
+                                pos - base,
+                            )
+                        )
+                        pos = match.end()
+
+                    else:
+                        # Unknown character (always one at a time)
+                        append(Token(TokenType.UNKNOWN, ch, line_num, pos - base))
+                        pos += 1
+
+            if next_base < length:
+                append(Token(TokenType.NEWLINE, "\n", line_num, end - base))
+            last_len = end - base
+            base = next_base
+
+        if pending is not None:
+            pending_type, parts, start_line, start_col = pending
+            append(Token(pending_type, "\n".join(parts), start_line, start_col))
+
+        append(Token(TokenType.EOF, "", line_num, last_len))
+
+        return tokens
+
+    def _merge_continuation_lines(self, content: str, value: str, line_start: int) -> str:
+        """Append the backslash-continued lines of a #define, starting at offset line_start"""
+        while value.rstrip().endswith("\\"):
+            # Remove the backslash and add a newline
+            value = value.rstrip()[:-1] + "\n"
+            if line_start >= len(content):
+                break
+            line_break = LINE_BREAK_RE.search(content, line_start)
+            line_end = line_break.start() if line_break else len(content)
+            value += content[line_start:line_end]
+            line_start = line_break.end() if line_break else len(content)
+        return value
+
     def _tokenize_line(self, line: str, line_num: int) -> List[Token]:
         """Tokenize a single line of code"""
         tokens = []
@@ -262,7 +515,9 @@ class CTokenizer:
         while pos < len(line):
             # Skip whitespace but track it
             if match := self.patterns["whitespace"].match(line, pos):
-                tokens.append(Token(TokenType.WHITESPACE, match.group(), line_num, pos))
+                tokens.append(
+                    Token(TokenType.WHITESPACE, sys.intern(match.group()), line_num, pos)
+                )
                 pos = match.end()
                 continue
 
@@ -383,7 +638,7 @@ class CTokenizer:
 
             # Identifiers and keywords
             if match := self.patterns["identifier"].match(line, pos):
-                value = match.group()
+                value = sys.intern(match.group())
                 token_type = self.KEYWORDS.get(value.lower(), TokenType.IDENTIFIER)
                 tokens.append(Token(token_type, value, line_num, pos))
                 pos = match.end()
@@ -400,15 +655,29 @@ class CTokenizer:
     ) -> List[Token]:
         """Filter tokens by type"""
         if exclude_types is None:
-            exclude_types = [
-                TokenType.WHITESPACE,
-                TokenType.COMMENT,
-                TokenType.NEWLINE,
-                TokenType.EOF,
-            ]
+            exclude_types = self.DEFAULT_FILTER_TYPES
+        else:
+            exclude_types = frozenset(exclude_types)
 
         return [token for token in tokens if token.type not in exclude_types]
 
+    def filter_tokens_with_positions(
+        self, tokens: List[Token], exclude_types: Optional[List[TokenType]] = None
+    ) -> Tuple[List[Token], List[int]]:
+        """Filter tokens by type and keep the index of every kept token
+
+        Returns:
+            Tuple of (filtered tokens, positions) where positions[i] is the
+            index of filtered_tokens[i] in tokens
+        """
+        if exclude_types is None:
+            exclude_types = self.DEFAULT_FILTER_TYPES
+        else:
+            exclude_types = frozenset(exclude_types)
+
+        positions = [i for i, token in enumerate(tokens) if token.type not in exclude_types]
+        return [tokens[i] for i in positions], positions
+
     def _merge_multiline_macros(
         self, tokens: List[Token], lines: List[str]
     ) -> List[Token]:
@@ -449,11 +718,30 @@ class CTokenizer:
         return merged_tokens
 
 
+class DeclarationScan:
+    """Struct, enum, union and function positions found by one declaration scan"""
+
+    __slots__ = ("structs", "enums", "unions", "functions")
+
+    def __init__(self):
+        # (start_pos, end_pos, name) in token order
+        self.structs: List[Tuple[int, int, str]] = []
+        self.enums: List[Tuple[int, int, str]] = []
+        self.unions: List[Tuple[int, int, str]] = []
+        # (start_pos, end_pos, func_name, return_type, is_declaration, is_inline)
+        self.functions: List[Tuple[int, int, str, str, bool, bool]] = []
+
+
 class StructureFinder:
     """Helper class to find C/C++ structures in token streams"""
 
-    def __init__(self, tokens: List[Token]):
+    # A function's '(' must lie within this many tokens of its reported start
+    FUNCTION_LOOKAHEAD = 50
+
+    def __init__(self, tokens: List[Token], original_positions: Optional[List[int]] = None):
         self.tokens = tokens
+        # Index of every token in the unfiltered stream it was filtered from
+        self.original_positions = original_positions
         self.pos = 0
         self.logger = logging.getLogger(__name__)
 
@@ -462,47 +750,65 @@ class StructureFinder:
         while self.pos < len(self.tokens) and self._current_token_is(TokenType.WHITESPACE):
             self.pos += 1
 
+    def scan_declarations(self) -> "DeclarationScan":
+        """Find struct, enum, union and function definitions in one walk
+
+        Each token is visited once. The struct, enum, union and function
+        scanners keep their own resume position and only run on the tokens
+        that can start their construct (struct/enum/union keywords, typedef
+        and opening parentheses), so the results are the same as running
+        every scanner over the whole stream on its own.
+        """
+        scan = DeclarationScan()
+        tokens = self.tokens
+        struct_next = enum_next = union_next = function_next = 0
+
+        for pos, token in enumerate(tokens):
+            token_type = token.type
+            if token_type == TokenType.LPAREN:
+                if pos >= function_next:
+                    function = self._function_at(pos)
+                    if function:
+                        # A function is reported from the earliest start whose
+                        # lookahead window (FUNCTION_LOOKAHEAD tokens) reaches it
+                        start_pos = max(function_next, pos - self.FUNCTION_LOOKAHEAD)
+                        scan.functions.append((start_pos,) + function)
+                        function_next = function[0] + 1
+                continue
+            is_typedef = token_type == TokenType.TYPEDEF
+            if (is_typedef or token_type == TokenType.STRUCT) and pos >= struct_next:
+                self.pos = pos
+                info = self._parse_typedef_struct() if is_typedef else self._parse_struct()
+                if info:
+                    scan.structs.append(info)
+                struct_next = self.pos
+            if (is_typedef or token_type == TokenType.ENUM) and pos >= enum_next:
+                self.pos = pos
+                info = self._parse_typedef_enum() if is_typedef else self._parse_enum()
+                if info:
+                    scan.enums.append(info)
+                enum_next = self.pos
+            if (is_typedef or token_type == TokenType.UNION) and pos >= union_next:
+                self.pos = pos
+                info = self._parse_typedef_union() if is_typedef else self._parse_union()
+                if info:
+                    scan.unions.append(info)
+                union_next = self.pos
+
+        self.pos = len(tokens)
+        return scan
+
     def find_structs(self) -> List[Tuple[int, int, str]]:
         """Find struct definitions in token stream
 
         Returns:
             List of tuples (start_pos, end_pos, struct_name)
         """
-        structs = []
-        self.pos = 0
-
-        while self.pos < len(self.tokens):
-            if self._current_token_is(TokenType.STRUCT):
-                struct_info = self._parse_struct()
-                if struct_info:
-                    structs.append(struct_info)
-            elif self._current_token_is(TokenType.TYPEDEF):
-                typedef_struct = self._parse_typedef_struct()
-                if typedef_struct:
-                    structs.append(typedef_struct)
-            else:
-                self.pos += 1
-
-        return structs
+        return self.scan_declarations().structs
 
     def find_enums(self) -> List[Tuple[int, int, str]]:
         """Find enum definitions in token stream"""
-        enums = []
-        self.pos = 0
-
-        while self.pos < len(self.tokens):
-            if self._current_token_is(TokenType.ENUM):
-                enum_info = self._parse_enum()
-                if enum_info:
-                    enums.append(enum_info)
-            elif self._current_token_is(TokenType.TYPEDEF):
-                typedef_enum = self._parse_typedef_enum()
-                if typedef_enum:
-                    enums.append(typedef_enum)
-            else:
-                self.pos += 1
-
-        return enums
+        return self.scan_declarations().enums
 
     def find_functions(self) -> List[Tuple[int, int, str, str, bool, bool]]:
         """Find all function declarations and definitions in the token stream
@@ -510,34 +816,11 @@ class StructureFinder:
         Returns:
             List of tuples (start_pos, end_pos, func_name, return_type, is_declaration, is_inline)
         """
-        functions = []
-        self.pos = 0
-
-        while self.pos < len(self.tokens):
-            result = self._parse_function()
-            if result:
-                functions.append(result)
-
-        return functions
+        return self.scan_declarations().functions
 
     def find_unions(self) -> List[Tuple[int, int, str]]:
         """Find union definitions in token stream"""
-        unions = []
-        self.pos = 0
-
-        while self.pos < len(self.tokens):
-            if self._current_token_is(TokenType.UNION):
-                union_info = self._parse_union()
-                if union_info:
-                    unions.append(union_info)
-            elif self._current_token_is(TokenType.TYPEDEF):
-                typedef_union = self._parse_typedef_union()
-                if typedef_union:
-                    unions.append(typedef_union)
-            else:
-                self.pos += 1
-
-        return unions
+        return self.scan_declarations().unions
 
     def _current_token_is(self, token_type: TokenType) -> bool:
         """Check if current token is of specified type"""
@@ -852,135 +1135,104 @@ class StructureFinder:
         # The typedef name will be handled separately in the parser
         return enum_info
 
-    def _parse_function(self) -> Optional[Tuple[int, int, str, str, bool, bool]]:
-        """Parse function declaration/definition
+    def _function_at(self, paren_pos: int) -> Optional[Tuple[int, str, str, bool, bool]]:
+        """Check whether the '(' at paren_pos opens a function's parameter list
+
+        Matches the pattern [modifiers] return_type function_name (params).
 
         Returns:
-            Tuple of (start_pos, end_pos, func_name, return_type, is_declaration, is_inline)
+            Tuple of (end_pos, func_name, return_type, is_declaration, is_inline)
         """
-        start_pos = self.pos
-
-        # Look for function pattern: [modifiers] return_type function_name (params)
-        while self.pos < len(self.tokens):
-            token = self.tokens[self.pos]
-
-            # If we hit a parenthesis, check if this is a function
-            if token.type == TokenType.LPAREN:
-                # Look backwards for function name
-                if (
-                    self.pos > 0
-                    and self.tokens[self.pos - 1].type == TokenType.IDENTIFIER
-                ):
-                    func_name = self.tokens[self.pos - 1].value
-                    func_name_pos = self.pos - 1
-
-                    # Look backwards from function name to find return type
-                    # Start from just before the function name
-                    return_type_end = func_name_pos - 1
-                    return_type_start = return_type_end
-
-                    # Skip backwards over whitespace and comments
-                    while return_type_start >= 0:
-                        token_type = self.tokens[return_type_start].type
-                        if token_type in [
-                            TokenType.WHITESPACE,
-                            TokenType.COMMENT,
-                            TokenType.NEWLINE,
-                        ]:
-                            return_type_start -= 1
-                        else:
-                            break
+        # Look backwards for function name
+        if paren_pos == 0 or self.tokens[paren_pos - 1].type != TokenType.IDENTIFIER:
+            return None
+        func_name = self.tokens[paren_pos - 1].value
+        func_name_pos = paren_pos - 1
+
+        # Look backwards from function name to find return type
+        # Start from just before the function name, skipping whitespace and comments
+        return_type_start = func_name_pos - 1
+        while return_type_start >= 0:
+            token_type = self.tokens[return_type_start].type
+            if token_type in [
+                TokenType.WHITESPACE,
+                TokenType.COMMENT,
+                TokenType.NEWLINE,
+            ]:
+                return_type_start -= 1
+            else:
+                break
 
-                    # If we found a non-whitespace token, that's the end of the return type
-                    # Find the start by looking backwards from there
-                    if return_type_start >= 0:
-                        return_type_end = return_type_start
-                        return_type_start = return_type_end
-
-                        # Define modifiers set (used in token type checking below)
-
-                        # Collect all tokens that are part of the return type (including modifiers)
-                        return_type_tokens = []
-
-                        # Look back at most 10 tokens to capture multi-token return types
-                        max_lookback = max(0, func_name_pos - 10)
-                        current_pos = return_type_start
-
-                        # Collect tokens backwards until we hit a limit or non-return-type token
-                        while current_pos >= max_lookback:
-                            token_type = self.tokens[current_pos].type
-                            if token_type in [
-                                TokenType.IDENTIFIER,
-                                TokenType.INT,
-                                TokenType.VOID,
-                                TokenType.CHAR,
-                                TokenType.FLOAT,
-                                TokenType.DOUBLE,
-                                TokenType.LONG,
-                                TokenType.SHORT,
-                                TokenType.UNSIGNED,
-                                TokenType.SIGNED,
-                                TokenType.ASTERISK,
-                                TokenType.CONST,
-                                TokenType.STATIC,
-                                TokenType.EXTERN,
-                                TokenType.INLINE,
-                                TokenType.LOCAL_INLINE,
-                            ]:
-                                return_type_tokens.insert(0, self.tokens[current_pos])
-                                current_pos -= 1
-                            elif token_type in [
-                                TokenType.WHITESPACE,
-                                TokenType.COMMENT,
-                                TokenType.NEWLINE,
-                            ]:
-                                # Skip whitespace and continue looking
-                                current_pos -= 1
-                            else:
-                                break
+        # If we found a non-whitespace token, that's the end of the return type
+        if return_type_start < 0:
+            return None
 
-                        # Extract return type
-                        if return_type_tokens:
-                            return_type = " ".join(
-                                t.value for t in return_type_tokens
-                            ).strip()
+        # Collect all tokens that are part of the return type (including modifiers)
+        return_type_tokens = []
+
+        # Look back at most 10 tokens to capture multi-token return types
+        max_lookback = max(0, func_name_pos - 10)
+        current_pos = return_type_start
+
+        # Collect tokens backwards until we hit a limit or non-return-type token
+        while current_pos >= max_lookback:
+            token_type = self.tokens[current_pos].type
+            if token_type in [
+                TokenType.IDENTIFIER,
+                TokenType.INT,
+                TokenType.VOID,
+                TokenType.CHAR,
+                TokenType.FLOAT,
+                TokenType.DOUBLE,
+                TokenType.LONG,
+                TokenType.SHORT,
+                TokenType.UNSIGNED,
+                TokenType.SIGNED,
+                TokenType.ASTERISK,
+                TokenType.CONST,
+                TokenType.STATIC,
+                TokenType.EXTERN,
+                TokenType.INLINE,
+                TokenType.LOCAL_INLINE,
+            ]:
+                return_type_tokens.insert(0, self.tokens[current_pos])
+                current_pos -= 1
+            elif token_type in [
+                TokenType.WHITESPACE,
+                TokenType.COMMENT,
+                TokenType.NEWLINE,
+            ]:
+                # Skip whitespace and continue looking
+                current_pos -= 1
+            else:
+                break
 
-                            # Check if function is inline
-                            is_inline = any(
-                                token.type in [TokenType.INLINE, TokenType.LOCAL_INLINE]
-                                for token in return_type_tokens
-                            )
-                            # Fallback: detect inline by textual prefix in return_type
-                            # This covers cases where macros like LOCAL_INLINE were not token-mapped earlier
-                            if not is_inline:
-                                rt_upper = return_type.upper()
-                                if rt_upper.startswith("LOCAL_INLINE ") or rt_upper.startswith("INLINE "):
-                                    is_inline = True
-
-                            # Find end of function (either ; for declaration or { for definition)
-                            end_pos = self._find_function_end(self.pos)
-                            if end_pos:
-                                # Determine if this is a declaration or definition
-                                is_declaration = self._is_function_declaration(end_pos)
-                                self.pos = end_pos + 1
-                                return (
-                                    start_pos,
-                                    end_pos,
-                                    func_name,
-                                    return_type,
-                                    is_declaration,
-                                    is_inline,
-                                )
+        if not return_type_tokens:
+            return None
 
-            self.pos += 1
+        # Extract return type
+        return_type = " ".join(t.value for t in return_type_tokens).strip()
 
-            # Prevent infinite loops - if we've gone too far, this isn't a function
-            if self.pos - start_pos > 50:
-                break
+        # Check if function is inline
+        is_inline = any(
+            token.type in [TokenType.INLINE, TokenType.LOCAL_INLINE]
+            for token in return_type_tokens
+        )
+        # Fallback: detect inline by textual prefix in return_type
+        # This covers cases where macros like LOCAL_INLINE were not token-mapped earlier
+        if not is_inline:
+            rt_upper = return_type.upper()
+            if rt_upper.startswith("LOCAL_INLINE ") or rt_upper.startswith("INLINE "):
+                is_inline = True
+
+        # Find end of function (either ; for declaration or { for definition)
+        end_pos = self._find_function_end(paren_pos)
+        if not end_pos:
+            return None
 
-        # Reset position if no function found
-        self.pos = start_pos + 1
-        return None
+        # Determine if this is a declaration or definition
+        is_declaration = self._is_function_declaration(end_pos)
+        return (end_pos, func_name, return_type, is_declaration, is_inline)
 
     def _is_function_declaration(self, end_pos: int) -> bool:
         """Check if the function at end_pos is a declaration (ends with ;) or definition (ends with })"""
@@ -1154,9 +1406,19 @@ def extract_token_range(tokens: List[Token], start: int, end: int) -> str:
 
 
 def find_struct_fields(
-    tokens: List[Token], struct_start: int, struct_end: int
+    tokens: List[Token],
+    struct_start: int,
+    struct_end: int,
+    nested_bodies: Optional[Dict[str, List[Token]]] = None,
 ) -> List[Tuple[str, str]]:
     """Extract field information from struct token range
+
+    Nested anonymous structs and unions are returned with their body text
+    embedded in a /*ANON:...*/ field type. When nested_bodies is given, the
+    tokens of each such body (braces included) are also stored under that
+    body text, so the anonymous processor can parse them without going back
+    through the text.
+
     Returns:
         List of tuples (field_name, field_type)
     """
@@ -1254,6 +1516,7 @@ def find_struct_fields(
                 if field_name:
                     # Extract the content between braces for anonymous processor using special format
                     content = _extract_brace_content(field_tokens)
+                    _record_nested_body(nested_bodies, content, field_tokens)
                     if content:
                         # Preserve content for anonymous processor using special format
                         import base64
@@ -1269,6 +1532,7 @@ def find_struct_fields(
                 else:
                     # Anonymous nested struct without a field name
                     content = _extract_brace_content(field_tokens)
+                    _record_nested_body(nested_bodies, content, field_tokens)
                     if content:
                         import base64
                         encoded_content = base64.b64encode(content.encode()).decode()
@@ -1303,6 +1567,7 @@ def find_struct_fields(
                 if field_name:
                     # Extract the content between braces for anonymous processor
                     content = _extract_brace_content(field_tokens)
+                    _record_nested_body(nested_bodies, content, field_tokens)
                     if content:
                         # Preserve content for anonymous processor using special format
                         import base64
@@ -1318,6 +1583,7 @@ def find_struct_fields(
                 else:
                     # Anonymous nested union without a field name
                     content = _extract_brace_content(field_tokens)
+                    _record_nested_body(nested_bodies, content, field_tokens)
                     if content:
                         import base64
                         encoded_content = base64.b64encode(content.encode()).decode()
@@ -1598,6 +1864,24 @@ def find_enum_values(tokens: List[Token], enum_start: int, enum_end: int) -> Lis
     return values
 
 
+def _record_nested_body(
+    nested_bodies: Optional[Dict[str, List[Token]]], content: str, field_tokens: List[Token]
+) -> None:
+    """Store the tokens of the first brace block of field_tokens under its content text"""
+    if nested_bodies is None or not content or content in nested_bodies:
+        return
+    start = next(i for i, token in enumerate(field_tokens) if token.type == TokenType.LBRACE)
+    depth = 0
+    for end in range(start, len(field_tokens)):
+        if field_tokens[end].type == TokenType.LBRACE:
+            depth += 1
+        elif field_tokens[end].type == TokenType.RBRACE:
+            depth -= 1
+            if depth == 0:
+                nested_bodies[content] = field_tokens[start:end + 1]
+                return
+
+
 def _extract_brace_content(field_tokens: List[Token]) -> str:
     """Extract the content between braces from field tokens.
     
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Compiled rename/remove pattern engine for the transformer.
+
+Every pattern list of a transformation container is compiled once. Patterns
+that can safely share one regex are fused into a single alternation, which
+answers "does any rule match" with one search, and results are cached per
+name so the cost grows with the number of distinct names instead of
+names x rules.
+"""
+
+import logging
+import re
+from typing import Dict, Iterable, List, Optional, Pattern, Tuple
+
+# Constructs that change meaning or fail when a pattern is embedded in an
+# alternation: group references and inline flags / named or conditional groups
+_UNFUSABLE_RE = re.compile(r"\\[1-9]|\\g<|\(\?(?![:=!]|<[=!])")
+
+
+def _compile(pattern: str, logger: logging.Logger) -> Optional[Pattern[str]]:
+    """Compile a pattern, logging (once) and skipping it when it is invalid"""
+    try:
+        return re.compile(pattern)
+    except re.error as e:
+        logger.warning("Invalid regex pattern '%s': %s", pattern, e)
+        return None
+
+
+def _fuse(patterns: Iterable[Pattern[str]]) -> Tuple[Optional[Pattern[str]], List[Pattern[str]]]:
+    """Split compiled patterns into one fused alternation and the rest
+
+    A fused search matches exactly when one of its member patterns matches.
+    """
+    fusable = []
+    separate = []
+    for pattern in patterns:
+        if _UNFUSABLE_RE.search(pattern.pattern):
+            separate.append(pattern)
+        else:
+            fusable.append(pattern)
+
+    if len(fusable) < 2:
+        return None, fusable + separate
+    try:
+        fused = re.compile("|".join(f"(?:{pattern.pattern})" for pattern in fusable))
+    except re.error:
+        return None, fusable + separate
+    return fused, separate
+
+
+class PatternMatcher:
+    """Answers whether a name matches any pattern of a list (re.search semantics)"""
+
+    def __init__(self, patterns: List[str], logger: logging.Logger):
+        compiled = [p for p in (_compile(pattern, logger) for pattern in patterns) if p]
+        self._init_compiled(compiled)
+
+    @classmethod
+    def from_compiled(cls, compiled: List[Pattern[str]]) -> "PatternMatcher":
+        """Create a matcher from already compiled patterns"""
+        matcher = cls.__new__(cls)
+        matcher._init_compiled(compiled)
+        return matcher
+
+    def _init_compiled(self, compiled: List[Pattern[str]]) -> None:
+        self.has_patterns = bool(compiled)
+        self._fused, self._separate = _fuse(compiled)
+        # Match results per name; a matcher is shared by every file of a run
+        self._cache: Dict[str, bool] = {}
+
+    def matches(self, name: str) -> bool:
+        """Return True if any pattern matches somewhere in name"""
+        result = self._cache.get(name)
+        if result is None:
+            result = bool(
+                (self._fused is not None and self._fused.search(name))
+                or any(pattern.search(name) for pattern in self._separate)
+            )
+            self._cache[name] = result
+        return result
+
+
+class RenameRules:
+    """Ordered rename rules: the first rule whose substitution changes a name wins"""
+
+    def __init__(self, patterns_map: Dict[str, str], logger: logging.Logger):
+        self._logger = logger
+        self._rules: List[Tuple[Pattern[str], str]] = []
+        for pattern, replacement in patterns_map.items():
+            compiled = _compile(pattern, logger)
+            if compiled is not None:
+                self._rules.append((compiled, replacement))
+        # A name no rule matches keeps its name, so the fused search rejects it
+        # before any substitution is tried
+        self._any_rule = PatternMatcher.from_compiled([rule for rule, _ in self._rules])
+        self._cache: Dict[str, str] = {}
+
+    def apply(self, original_name: str) -> str:
+        """Return the renamed name (unchanged if no rule applies)"""
+        new_name = self._cache.get(original_name)
+        if new_name is None:
+            new_name = self._rename(original_name)
+            self._cache[original_name] = new_name
+        return new_name
+
+    def _rename(self, original_name: str) -> str:
+        if not self._any_rule.matches(original_name):
+            return original_name
+        for pattern, replacement in self._rules:
+            try:
+                new_name = pattern.sub(replacement, original_name)
+            except re.error as e:
+                # Invalid replacement template (e.g. unknown group reference)
+                self._logger.warning("Invalid regex pattern '%s': %s", pattern.pattern, e)
+                continue
+            if new_name != original_name:
+                self._logger.debug(
+                    "Renamed '%s' to '%s' using pattern '%s'",
+                    original_name, new_name, pattern.pattern
+                )
+                return new_name
+        return original_name
+
+
+class PatternEngine:
+    """Compiles each distinct pattern list or rename map once per transformer run"""
+
+    def __init__(self, logger: Optional[logging.Logger] = None):
+        self._logger = logger or logging.getLogger(__name__)
+        self._matchers: Dict[Tuple[str, ...], PatternMatcher] = {}
+        self._renamers: Dict[Tuple[Tuple[str, str], ...], RenameRules] = {}
+
+    def matcher(self, patterns: List[str]) -> PatternMatcher:
+        """Return the cached matcher for a list of patterns"""
+        key = tuple(patterns)
+        matcher = self._matchers.get(key)
+        if matcher is None:
+            matcher = PatternMatcher(list(patterns), self._logger)
+            self._matchers[key] = matcher
+        return matcher
+
+    def rename_rules(self, patterns_map: Dict[str, str]) -> RenameRules:
+        """Return the cached rename rules for a pattern -> replacement map"""
+        key = tuple(patterns_map.items())
+        rules = self._renamers.get(key)
+        if rules is None:
+            rules = RenameRules(patterns_map, self._logger)
+            self._renamers[key] = rules
+        return rules
@@ -5,12 +5,26 @@ Handles #if, #elif, #else, #endif directives and conditional compilation.
 """
 
 import logging
+import os
 import re
 from dataclasses import dataclass
 from enum import Enum
-from typing import Dict, List, Optional, Set, Tuple
+from pathlib import Path
+from typing import Callable, Dict, Iterable, List, Optional, Set, Tuple
 
 from .parser_tokenizer import Token, TokenType
+from .preprocessor_expression import ConditionError, compile_condition
+
+# How #if conditions see macros: "project" evaluates every file against one
+# define state shared in parse order; "translation_unit" evaluates each file
+# against its own include chain (see TranslationUnitPreprocessor)
+PREPROCESSOR_MODES = ("project", "translation_unit")
+
+HEADER_EXTENSIONS = (".h", ".hpp", ".hxx")
+
+_DIRECTIVE_RE = re.compile(r"#\s*(\w+)")
+_DEFINE_RE = re.compile(r"#\s*define\s+([A-Za-z_]\w*)(?:\([^)]*\))?\s*(.*)", re.DOTALL)
+_INCLUDE_RE = re.compile(r'#\s*include\s*[<"]([^>"]+)[>"]')
 
 
 class PreprocessorDirective(Enum):
@@ -42,24 +56,50 @@ class PreprocessorBlock:
 class PreprocessorEvaluator:
     """Evaluates preprocessor conditions and manages conditional compilation."""
 
-    def __init__(self):
+    def __init__(self, compiled: bool = False):
         self.logger = logging.getLogger(__name__)
+        # compiled: evaluate #if conditions with C semantics through
+        # compile_condition(), keeping the string heuristics as the fallback
+        # for syntax it does not support
+        self.compiled = compiled
         self.defined_macros: Set[str] = set()
         self.macro_values: Dict[str, str] = {}
         self.blocks: List[PreprocessorBlock] = []
         self.current_block_stack: List[PreprocessorBlock] = []
+        # When set, every define (name, value) and undef (name, None) is appended
+        # so the evaluator state can be rebuilt with replay()
+        self.journal: Optional[List[Tuple[str, Optional[str]]]] = None
+        # Bumped on every define and undef; condition results are memoized
+        # for the current version only
+        self.version = 0
+        self._condition_results: Dict[str, bool] = {}
+        self._results_version = 0
 
     def add_define(self, name: str, value: str = ""):
         """Add a defined macro."""
+        if self.journal is not None:
+            self.journal.append((name, value))
+        self.version += 1
         self.defined_macros.add(name)
         if value:
             self.macro_values[name] = value
 
     def add_undef(self, name: str):
         """Remove a defined macro."""
+        if self.journal is not None:
+            self.journal.append((name, None))
+        self.version += 1
         self.defined_macros.discard(name)
         self.macro_values.pop(name, None)
 
+    def replay(self, operations: List[Tuple[str, Optional[str]]]):
+        """Apply journaled defines and undefs in their original order."""
+        for name, value in operations:
+            if value is None:
+                self.add_undef(name)
+            else:
+                self.add_define(name, value)
+
     def is_defined(self, name: str) -> bool:
         """Check if a macro is defined."""
         return name in self.defined_macros
@@ -73,6 +113,23 @@ class PreprocessorEvaluator:
         if not condition.strip():
             return True
 
+        if self._results_version != self.version:
+            self._condition_results.clear()
+            self._results_version = self.version
+        result = self._condition_results.get(condition)
+        if result is None:
+            result = self._evaluate_uncached(condition)
+            self._condition_results[condition] = result
+        return result
+
+    def _evaluate_uncached(self, condition: str) -> bool:
+        """Evaluate a condition against the current macros."""
+        if self.compiled:
+            try:
+                return bool(compile_condition(condition)(self))
+            except ConditionError:
+                pass
+
         # Handle defined() operator
         condition = self._expand_defined_operator(condition)
 
@@ -411,49 +468,62 @@ class PreprocessorEvaluator:
     def filter_tokens(self, tokens: List[Token]) -> List[Token]:
         """Filter tokens based on preprocessor blocks, keeping only active content."""
         blocks = self.parse_preprocessor_blocks(tokens)
-        filtered_tokens = []
+        inactive_ranges = self._collect_inactive_ranges(blocks)
 
-        i = 0
-        while i < len(tokens):
-            token = tokens[i]
+        # Sweep once over the active gaps between the sorted inactive ranges
+        filtered_tokens = []
+        active_start = 0
+        for range_start, range_end in inactive_ranges + [(len(tokens), len(tokens))]:
+            filtered_tokens.extend(
+                token
+                for token in tokens[active_start:range_start]
+                if token.type != TokenType.PREPROCESSOR
+            )
+            active_start = range_end + 1
 
-            # Check if this token is inside a preprocessor block
-            in_active_block = self._is_token_in_active_block(i, blocks)
+        return filtered_tokens
 
-            if in_active_block:
-                # Include the token if it's not a preprocessor directive
-                if token.type != TokenType.PREPROCESSOR:
-                    filtered_tokens.append(token)
+    def _collect_inactive_ranges(
+        self, blocks: List[PreprocessorBlock]
+    ) -> List[Tuple[int, int]]:
+        """Flatten the block tree into sorted, merged inactive token index ranges.
+
+        A token's activity depends on the chain of closed blocks containing it,
+        evaluated from the innermost block outwards: the innermost block decides
+        first and each enclosing block only applies when the inner result was
+        active. Unclosed blocks (end_token == -1) never contain tokens.
+        """
+        ranges: List[Tuple[int, int]] = []
+
+        def add_range(start: int, end: int, chain: List[bool]) -> None:
+            if start > end:
+                return
+            is_active = chain[-1]
+            for outer_active in reversed(chain[:-1]):
+                is_active = outer_active if is_active else True
+            if is_active:
+                return
+            if ranges and ranges[-1][1] + 1 >= start:
+                ranges[-1] = (ranges[-1][0], end)
             else:
-                # Skip tokens that are not in active blocks
-                pass
+                ranges.append((start, end))
 
-            i += 1
-
-        return filtered_tokens
+        def visit(block: PreprocessorBlock, chain: List[bool]) -> None:
+            chain = chain + [block.is_active]
+            position = block.start_token
+            for child in block.children:
+                if child.end_token == -1:
+                    continue
+                add_range(position, child.start_token - 1, chain)
+                visit(child, chain)
+                position = child.end_token + 1
+            add_range(position, block.end_token, chain)
 
-    def _is_token_in_active_block(
-        self, token_index: int, blocks: List[PreprocessorBlock]
-    ) -> bool:
-        """Check if a token is inside an active preprocessor block."""
-        # Check all blocks recursively
         for block in blocks:
-            if self._is_token_in_block(token_index, block):
-                # If token is in this block, return whether the block is active
-                return block.is_active
-        return True  # Default to True if not in any block
-
-    def _is_token_in_block(self, token_index: int, block: PreprocessorBlock) -> bool:
-        """Check if a token is inside a specific block."""
-        if block.start_token <= token_index <= block.end_token:
-            # Check if any child block contains this token
-            for child in block.children:
-                if self._is_token_in_block(token_index, child):
-                    # If token is in a child block, return whether the child is active
-                    return child.is_active
-            # Token is in this block but not in any child block
-            return True
-        return False
+            if block.end_token != -1:
+                visit(block, [])
+
+        return ranges
 
 
 class PreprocessorManager:
@@ -489,3 +559,191 @@ class PreprocessorManager:
                 if name:
                     self.evaluator.add_define(name, value)
                     self.logger.debug("Preprocessor: Added define %s = %s", name, value)
+
+
+@dataclass(frozen=True)
+class DefineSnapshot:
+    """Net effect of a header on the define state
+
+    changes holds (name, value) pairs in name order; a value of None means the
+    header leaves the macro undefined.
+    """
+
+    changes: Tuple[Tuple[str, Optional[str]], ...] = ()
+
+
+class TranslationUnitPreprocessor:
+    """Evaluates conditional compilation per translation unit
+
+    Every file starts from the same base define set and sees only the macros of
+    its own include chain: an active #include of a project header applies that
+    header's DefineSnapshot at the point of inclusion. A header's snapshot is
+    computed once, from the base set with its own includes applied the same
+    way, and never changes afterwards, so results do not depend on the parse
+    order and the snapshot table can be handed to worker processes as is.
+    Include cycles are cut at the header already being evaluated.
+    """
+
+    def __init__(
+        self,
+        header_paths: Iterable[str],
+        load_tokens: Callable[[Path], List[Token]],
+        base_defines: Optional[Dict[str, str]] = None,
+        snapshots: Optional[Dict[str, DefineSnapshot]] = None,
+    ):
+        self.logger = logging.getLogger(__name__)
+        self.header_paths = sorted({os.path.normpath(str(path)) for path in header_paths})
+        self.base_defines = dict(base_defines or {})
+        self.snapshots: Dict[str, DefineSnapshot] = dict(snapshots or {})
+        # File path -> headers whose snapshots its last evaluation applied
+        self.dependencies: Dict[str, frozenset] = {}
+        self._load_tokens = load_tokens
+        self._paths = set(self.header_paths)
+        self._by_name: Dict[str, str] = {}
+        for path in self.header_paths:
+            self._by_name.setdefault(os.path.basename(path), path)
+
+    def reusable_snapshots(self, changed: Set[str]) -> Dict[str, DefineSnapshot]:
+        """Return the snapshots still valid after the given headers changed
+
+        A snapshot is dropped when its header changed or (transitively)
+        includes a changed header.
+        """
+        dirty = {os.path.normpath(path) for path in changed}
+        grew = True
+        while grew:
+            grew = False
+            for path in self.snapshots:
+                if path not in dirty and not self.dependencies.get(path, frozenset()).isdisjoint(dirty):
+                    dirty.add(path)
+                    grew = True
+        return {path: snapshot for path, snapshot in self.snapshots.items() if path not in dirty}
+
+    def compute_all(self) -> Dict[str, DefineSnapshot]:
+        """Compute the snapshot of every known header (already known ones are kept)"""
+        for path in self.header_paths:
+            self._snapshot(path, set())
+        return self.snapshots
+
+    def process_file(self, file_path, tokens: List[Token]) -> List[Token]:
+        """Return the active tokens of a file, evaluated against its own include chain"""
+        path = os.path.normpath(str(file_path))
+        dependencies: Set[str] = set()
+        filtered, changes = self._evaluate(path, tokens, {path}, dependencies)
+        self.dependencies[path] = frozenset(dependencies)
+        if path in self._paths and path not in self.snapshots:
+            self.snapshots[path] = self._freeze(changes)
+        return filtered
+
+    def resolve_include(self, including_path: str, directive: str) -> Optional[str]:
+        """Return the project header an #include directive names, if any
+
+        The name is tried relative to the including file first, then matched
+        by filename (filenames are unique model keys).
+        """
+        match = _INCLUDE_RE.match(directive.strip())
+        if not match:
+            return None
+        name = match.group(1).strip()
+        candidate = os.path.normpath(os.path.join(os.path.dirname(including_path), name))
+        if candidate in self._paths:
+            return candidate
+        return self._by_name.get(os.path.basename(name))
+
+    def _snapshot(self, path: str, in_progress: Set[str]) -> DefineSnapshot:
+        """Return a header's snapshot, computing it on first use"""
+        snapshot = self.snapshots.get(path)
+        if snapshot is not None:
+            return snapshot
+        try:
+            tokens = self._load_tokens(Path(path))
+        except (OSError, ValueError) as e:
+            self.logger.warning("Cannot read header %s for its defines: %s", path, e)
+            tokens = []
+        dependencies: Set[str] = set()
+        _, changes = self._evaluate(path, tokens, in_progress | {path}, dependencies)
+        self.dependencies[path] = frozenset(dependencies)
+        snapshot = self.snapshots[path] = self._freeze(changes)
+        return snapshot
+
+    @staticmethod
+    def _freeze(changes: Dict[str, Optional[str]]) -> DefineSnapshot:
+        return DefineSnapshot(tuple(sorted(changes.items())))
+
+    def _evaluate(
+        self,
+        path: str,
+        tokens: List[Token],
+        in_progress: Set[str],
+        dependencies: Set[str],
+    ) -> Tuple[List[Token], Dict[str, Optional[str]]]:
+        """Walk one file's directives in order
+
+        Returns the active tokens (directives other than #include and #define
+        dropped, as in project mode) and the file's net define changes.
+        """
+        evaluator = PreprocessorEvaluator(compiled=True)
+        for name, value in self.base_defines.items():
+            evaluator.add_define(name, value)
+        changes: Dict[str, Optional[str]] = {}
+
+        def define(name: str, value: Optional[str]) -> None:
+            evaluator.add_undef(name)
+            if value is not None:
+                evaluator.add_define(name, value)
+            changes[name] = value
+
+        # One (enclosing block active, branch taken) pair per open conditional
+        stack: List[Tuple[bool, bool]] = []
+        active = True
+        filtered: List[Token] = []
+        for token in tokens:
+            token_type = token.type
+            if token_type == TokenType.PREPROCESSOR:
+                match = _DIRECTIVE_RE.match(token.value.strip())
+                directive = match.group(1) if match else ""
+                if directive in ("if", "ifdef", "ifndef"):
+                    taken = active and self._condition(evaluator, directive, token.value)
+                    stack.append((active, taken))
+                    active = taken
+                elif directive == "elif" and stack:
+                    enclosing, taken = stack[-1]
+                    active = enclosing and not taken and self._condition(
+                        evaluator, directive, token.value
+                    )
+                    stack[-1] = (enclosing, taken or active)
+                elif directive == "else" and stack:
+                    enclosing, taken = stack[-1]
+                    active = enclosing and not taken
+                    stack[-1] = (enclosing, True)
+                elif directive == "endif" and stack:
+                    active = stack.pop()[0]
+                elif directive == "undef" and active:
+                    name = evaluator._parse_undef(token.value)
+                    if name:
+                        define(name, None)
+                continue
+            if not active:
+                continue
+            if token_type == TokenType.DEFINE:
+                match = _DEFINE_RE.match(token.value.strip())
+                if match:
+                    define(match.group(1), match.group(2).strip())
+            elif token_type == TokenType.INCLUDE:
+                header = self.resolve_include(path, token.value)
+                if header is not None and header not in in_progress:
+                    dependencies.add(header)
+                    for name, value in self._snapshot(header, in_progress).changes:
+                        define(name, value)
+            filtered.append(token)
+        return filtered, changes
+
+    @staticmethod
+    def _condition(evaluator: PreprocessorEvaluator, directive: str, value: str) -> bool:
+        """Evaluate the condition of an #if, #ifdef, #ifndef or #elif directive"""
+        if directive in ("ifdef", "ifndef"):
+            match = re.match(r"#\s*\w+\s+([A-Za-z_]\w*)", value.strip())
+            defined = bool(match) and evaluator.is_defined(match.group(1))
+            return defined if directive == "ifdef" else not defined
+        condition = re.sub(r"^#\s*\w+", "", value.strip()).strip()
+        return evaluator.evaluate_condition(condition)
@@ -0,0 +1,295 @@
+#!/usr/bin/env python3
+"""
+Compiled #if / #elif condition expressions for the preprocessor.
+
+compile_condition() parses a condition once into a tree of closures with the
+C operator precedence (ternary, logical, bitwise, comparison, shift,
+additive, multiplicative and unary operators) and integer arithmetic.
+Compiled conditions are cached by their text, so a condition repeated across
+thousands of blocks is parsed a single time; evaluating it only walks the
+closures against the evaluator's current macros.
+
+Identifiers follow the C rules with one leniency: an undefined name is 0, a
+macro defined with an empty or non-numeric value is 1, and any other macro
+evaluates to its (recursively compiled) value. Conditions outside this
+subset, such as function-like macro calls or __has_include, raise
+ConditionError so the caller can fall back to its own evaluation.
+"""
+
+import re
+from functools import lru_cache
+from typing import Callable, List, Protocol, Tuple
+
+_TOKEN_RE = re.compile(
+    r"\s*(?:"
+    r"(?P<number>0[xX][0-9a-fA-F]+|\d+)[uUlL]*"
+    r"|(?P<char>'(?:\\.|[^\\'])')"
+    r"|(?P<name>[A-Za-z_]\w*)"
+    r"|(?P<op>\|\||&&|==|!=|<=|>=|<<|>>|[-+*/%<>!~&|^?:(),])"
+    r")"
+)
+
+_COMMENT_RE = re.compile(r"/\*.*?\*/|//[^\n]*", re.DOTALL)
+
+_CHAR_ESCAPES = {"n": 10, "t": 9, "r": 13, "0": 0, "\\": 92, "'": 39, '"': 34, "a": 7, "b": 8, "f": 12, "v": 11}
+
+# Binary operators by precedence level, loosest first (ternary is handled apart)
+_BINARY_LEVELS: Tuple[Tuple[str, ...], ...] = (
+    ("||",),
+    ("&&",),
+    ("|",),
+    ("^",),
+    ("&",),
+    ("==", "!="),
+    ("<", ">", "<=", ">="),
+    ("<<", ">>"),
+    ("+", "-"),
+    ("*", "/", "%"),
+)
+
+# Nested macro values deeper than this are treated as defined (1)
+MAX_MACRO_DEPTH = 32
+
+
+class ConditionError(ValueError):
+    """A condition uses syntax the compiled evaluator does not support"""
+
+
+class MacroEnvironment(Protocol):
+    """What a compiled condition reads from the preprocessor evaluator"""
+
+    def is_defined(self, name: str) -> bool: ...
+
+    def get_macro_value(self, name: str) -> str: ...
+
+
+CompiledCondition = Callable[[MacroEnvironment], int]
+
+
+def _int_literal(text: str) -> int:
+    """Return the value of an integer literal without suffix: hex, octal or decimal"""
+    try:
+        if text[:2] in ("0x", "0X"):
+            return int(text, 16)
+        return int(text, 8 if text.startswith("0") and len(text) > 1 else 10)
+    except ValueError:
+        raise ConditionError(f"invalid integer literal '{text}'")
+
+
+def _c_div(left: int, right: int) -> int:
+    if right == 0:
+        raise ConditionError("division by zero")
+    quotient = abs(left) // abs(right)
+    return quotient if (left < 0) == (right < 0) else -quotient
+
+
+def _c_mod(left: int, right: int) -> int:
+    return left - right * _c_div(left, right)
+
+
+def _shift(left: int, right: int, to_left: bool) -> int:
+    if right < 0:
+        raise ConditionError("negative shift count")
+    return left << right if to_left else left >> right
+
+
+_BINARY_FUNCTIONS = {
+    "|": lambda a, b: a | b,
+    "^": lambda a, b: a ^ b,
+    "&": lambda a, b: a & b,
+    "==": lambda a, b: int(a == b),
+    "!=": lambda a, b: int(a != b),
+    "<": lambda a, b: int(a < b),
+    ">": lambda a, b: int(a > b),
+    "<=": lambda a, b: int(a <= b),
+    ">=": lambda a, b: int(a >= b),
+    "<<": lambda a, b: _shift(a, b, True),
+    ">>": lambda a, b: _shift(a, b, False),
+    "+": lambda a, b: a + b,
+    "-": lambda a, b: a - b,
+    "*": lambda a, b: a * b,
+    "/": _c_div,
+    "%": _c_mod,
+}
+
+
+def _tokenize(text: str) -> List[Tuple[str, str]]:
+    """Split a condition into (kind, value) tokens"""
+    tokens = []
+    position = 0
+    text = text.rstrip()
+    while position < len(text):
+        match = _TOKEN_RE.match(text, position)
+        if not match or match.end() == position:
+            raise ConditionError(f"unexpected character in condition: {text[position:]!r}")
+        position = match.end()
+        kind = match.lastgroup
+        tokens.append((kind, match.group(kind)))
+    return tokens
+
+
+def _char_value(literal: str) -> int:
+    body = literal[1:-1]
+    if body.startswith("\\"):
+        escape = body[1:]
+        if escape in _CHAR_ESCAPES:
+            return _CHAR_ESCAPES[escape]
+        if escape.startswith("x"):
+            return int(escape[1:], 16)
+        if escape.isdigit():
+            return int(escape, 8)
+        raise ConditionError(f"unknown escape in {literal}")
+    return ord(body)
+
+
+class _Parser:
+    """Recursive descent parser producing closures"""
+
+    def __init__(self, tokens: List[Tuple[str, str]]):
+        self.tokens = tokens
+        self.position = 0
+
+    def peek(self) -> Tuple[str, str]:
+        if self.position < len(self.tokens):
+            return self.tokens[self.position]
+        return ("end", "")
+
+    def take(self) -> Tuple[str, str]:
+        token = self.peek()
+        self.position += 1
+        return token
+
+    def expect(self, value: str) -> None:
+        kind, token = self.take()
+        if kind != "op" or token != value:
+            raise ConditionError(f"expected '{value}', got '{token}'")
+
+    def parse(self) -> CompiledCondition:
+        node = self.ternary()
+        if self.peek()[0] != "end":
+            raise ConditionError(f"unexpected '{self.peek()[1]}'")
+        return node
+
+    def ternary(self) -> CompiledCondition:
+        condition = self.binary(0)
+        if self.peek() == ("op", "?"):
+            self.take()
+            when_true = self.ternary()
+            self.expect(":")
+            when_false = self.ternary()
+            return lambda env: when_true(env) if condition(env) else when_false(env)
+        return condition
+
+    def binary(self, level: int) -> CompiledCondition:
+        if level == len(_BINARY_LEVELS):
+            return self.unary()
+        operators = _BINARY_LEVELS[level]
+        left = self.binary(level + 1)
+        while self.peek()[0] == "op" and self.peek()[1] in operators:
+            operator = self.take()[1]
+            right = self.binary(level + 1)
+            left = self._combine(operator, left, right)
+        return left
+
+    @staticmethod
+    def _combine(operator: str, left: CompiledCondition, right: CompiledCondition) -> CompiledCondition:
+        if operator == "||":
+            return lambda env: int(bool(left(env)) or bool(right(env)))
+        if operator == "&&":
+            return lambda env: int(bool(left(env)) and bool(right(env)))
+        function = _BINARY_FUNCTIONS[operator]
+        return lambda env: function(left(env), right(env))
+
+    def unary(self) -> CompiledCondition:
+        kind, value = self.peek()
+        if kind == "op" and value in ("!", "~", "-", "+"):
+            self.take()
+            operand = self.unary()
+            if value == "!":
+                return lambda env: int(not operand(env))
+            if value == "~":
+                return lambda env: ~operand(env)
+            if value == "-":
+                return lambda env: -operand(env)
+            return operand
+        return self.primary()
+
+    def primary(self) -> CompiledCondition:
+        kind, value = self.take()
+        if kind == "number":
+            number = _int_literal(value)
+            return lambda env: number
+        if kind == "char":
+            number = _char_value(value)
+            return lambda env: number
+        if kind == "name":
+            if value == "defined":
+                return self.defined()
+            if self.peek() == ("op", "("):
+                raise ConditionError(f"function-like macro call '{value}(...)'")
+            return lambda env: identifier_value(env, value)
+        if kind == "op" and value == "(":
+            node = self.ternary()
+            self.expect(")")
+            return node
+        raise ConditionError(f"unexpected '{value}'" if value else "unexpected end of condition")
+
+    def defined(self) -> CompiledCondition:
+        parenthesized = self.peek() == ("op", "(")
+        if parenthesized:
+            self.take()
+        kind, name = self.take()
+        if kind != "name":
+            raise ConditionError("defined needs a macro name")
+        if parenthesized:
+            self.expect(")")
+        return lambda env: int(env.is_defined(name))
+
+
+def identifier_value(env: MacroEnvironment, name: str) -> int:
+    """Return the integer value of an identifier in a condition"""
+    if not env.is_defined(name):
+        return 0
+    value = env.get_macro_value(name).strip()
+    if value.isdigit():
+        # Same reading as a literal in the condition, so 010 is 8
+        try:
+            return _int_literal(value)
+        except ConditionError:
+            return 1
+    depth = env.depth if isinstance(env, _NestedEnvironment) else 0
+    if not value or depth >= MAX_MACRO_DEPTH:
+        return 1
+    try:
+        compiled = compile_condition(value)
+    except ConditionError:
+        return 1
+    # Names inside the value resolve one level deeper, which stops self reference
+    root = env.env if isinstance(env, _NestedEnvironment) else env
+    return compiled(_NestedEnvironment(root, depth + 1))
+
+
+class _NestedEnvironment:
+    """Environment seen while evaluating a macro's value"""
+
+    __slots__ = ("env", "depth")
+
+    def __init__(self, env: MacroEnvironment, depth: int):
+        self.env = env
+        self.depth = depth
+
+    def is_defined(self, name: str) -> bool:
+        return self.env.is_defined(name)
+
+    def get_macro_value(self, name: str) -> str:
+        return self.env.get_macro_value(name)
+
+
+@lru_cache(maxsize=4096)
+def compile_condition(condition: str) -> CompiledCondition:
+    """Compile a condition into a callable returning its integer value
+
+    Raises ConditionError for unsupported syntax; results are cached by text.
+    """
+    text = _COMMENT_RE.sub(" ", condition.replace("\\\n", " "))
+    return _Parser(_tokenize(text)).parse()
@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+"""
+Opt-in per-stage timing and memory instrumentation.
+
+The module level PROFILER is disabled unless main enables it for
+--profile-report; a disabled profiler hands out one shared no-op context, so
+the instrumented code paths cost a single attribute check. When enabled, each
+named stage records its call count, wall time and allocation peak (traced
+with tracemalloc, relative to the memory in use when the stage started).
+Stages may nest. Parse workers and generation workers profile into their own
+PROFILER and send a drained snapshot back with every result, which the main
+process merges before the report is written.
+"""
+
+import functools
+import json
+import time
+import tracemalloc
+from typing import Dict, List, Optional
+
+from .. import __version__
+
+PROFILE_REPORT_FORMAT = "c2puml-profile-report"
+PROFILE_REPORT_VERSION = 1
+DEFAULT_TOP_FILES = 10
+
+
+class _NullStage:
+    """Context returned while profiling is disabled"""
+
+    __slots__ = ()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        return False
+
+
+_NULL_STAGE = _NullStage()
+
+
+class _Stage:
+    """One running stage; pushes itself on the profiler's stage stack"""
+
+    __slots__ = ("profiler", "name", "item", "start", "start_memory", "peak")
+
+    def __init__(self, profiler: "Profiler", name: str, item: Optional[str]):
+        self.profiler = profiler
+        self.name = name
+        self.item = item
+
+    def __enter__(self):
+        self.profiler._enter(self)
+        return self
+
+    def __exit__(self, *exc_info):
+        self.profiler._exit(self)
+        return False
+
+
+class _FileScope(_Stage):
+    """Times the parse of one file and collects its notes (e.g. token count)"""
+
+    __slots__ = ("notes",)
+
+    def __enter__(self):
+        self.notes = {}
+        self.profiler._files_open.append(self)
+        return super().__enter__()
+
+    def __exit__(self, *exc_info):
+        super().__exit__(*exc_info)
+        self.profiler._files_open.pop()
+        return False
+
+
+class Profiler:
+    """Collects stage statistics and per-file records"""
+
+    def __init__(self):
+        self.enabled = False
+        self.trace_memory = False
+        self._reset()
+
+    def _reset(self) -> None:
+        self._started = time.perf_counter()
+        # name -> [calls, seconds, max_seconds, peak_bytes]
+        self._stages: Dict[str, List[float]] = {}
+        # stage name -> item -> [seconds, peak_bytes]
+        self._items: Dict[str, Dict[str, List[float]]] = {}
+        # relative path -> {"seconds": ..., "peak_bytes": ..., "stages": {...}, notes}
+        self._files: Dict[str, Dict[str, object]] = {}
+        self._stack: List[_Stage] = []
+        self._files_open: List[_FileScope] = []
+
+    def start(self, trace_memory: bool = True) -> None:
+        """Enable profiling and discard everything recorded so far"""
+        self._reset()
+        self.enabled = True
+        self.trace_memory = trace_memory
+        if trace_memory and not tracemalloc.is_tracing():
+            tracemalloc.start()
+
+    def stop(self) -> None:
+        """Disable profiling (recorded data is kept until the next start)"""
+        self.enabled = False
+        if self.trace_memory and tracemalloc.is_tracing():
+            tracemalloc.stop()
+        self.trace_memory = False
+
+    def stage(self, name: str, item: Optional[str] = None):
+        """Return a context manager timing one run of a stage
+
+        item names the unit a stage ran for (e.g. a diagram); items are
+        reported individually in addition to the stage totals.
+        """
+        if not self.enabled:
+            return _NULL_STAGE
+        return _Stage(self, name, item)
+
+    def profiled(self, name: str):
+        """Decorator recording every call of a function as one run of a stage"""
+
+        def decorate(func):
+            @functools.wraps(func)
+            def wrapper(*args, **kwargs):
+                if not self.enabled:
+                    return func(*args, **kwargs)
+                with _Stage(self, name, None):
+                    return func(*args, **kwargs)
+
+            return wrapper
+
+        return decorate
+
+    def file(self, relative_path: str):
+        """Return a context manager timing the parse of one file"""
+        if not self.enabled:
+            return _NULL_STAGE
+        return _FileScope(self, "parse.file", relative_path)
+
+    def note(self, **values) -> None:
+        """Attach values (e.g. tokens=...) to the file currently being parsed"""
+        if self.enabled and self._files_open:
+            self._files_open[-1].notes.update(values)
+
+    def _enter(self, stage: _Stage) -> None:
+        self._stages.setdefault(stage.name, [0, 0.0, 0.0, 0])
+        stage.peak = 0
+        stage.start_memory = 0
+        if self.trace_memory:
+            current, peak = tracemalloc.get_traced_memory()
+            if self._stack:
+                parent = self._stack[-1]
+                parent.peak = max(parent.peak, peak)
+            stage.start_memory = current
+            # reset_peak is Python 3.9+; older versions report the run's peak so far
+            if hasattr(tracemalloc, "reset_peak"):
+                tracemalloc.reset_peak()
+        self._stack.append(stage)
+        stage.start = time.perf_counter()
+
+    def _exit(self, stage: _Stage) -> None:
+        seconds = time.perf_counter() - stage.start
+        self._stack.pop()
+        peak_bytes = 0
+        if self.trace_memory:
+            absolute_peak = max(stage.peak, tracemalloc.get_traced_memory()[1])
+            peak_bytes = max(0, absolute_peak - stage.start_memory)
+            if self._stack:
+                parent = self._stack[-1]
+                parent.peak = max(parent.peak, absolute_peak)
+            if hasattr(tracemalloc, "reset_peak"):
+                tracemalloc.reset_peak()
+
+        stats = self._stages.setdefault(stage.name, [0, 0.0, 0.0, 0])
+        stats[0] += 1
+        stats[1] += seconds
+        stats[2] = max(stats[2], seconds)
+        stats[3] = max(stats[3], peak_bytes)
+
+        if isinstance(stage, _FileScope):
+            record = dict(stage.notes)
+            record.setdefault("stages", {})
+            record.update(seconds=seconds, peak_bytes=peak_bytes)
+            self._files[stage.item] = record
+            return
+        if stage.item is not None:
+            item = self._items.setdefault(stage.name, {}).setdefault(stage.item, [0.0, 0])
+            item[0] += seconds
+            item[1] = max(item[1], peak_bytes)
+        if self._files_open:
+            file_stages = self._files_open[-1].notes.setdefault("stages", {})
+            file_stages[stage.name] = file_stages.get(stage.name, 0.0) + seconds
+
+    def drain(self) -> Optional[dict]:
+        """Return and clear the data recorded so far (None when disabled)
+
+        Used by worker processes to send their records with each result.
+        """
+        if not self.enabled:
+            return None
+        snapshot = {"stages": self._stages, "items": self._items, "files": self._files}
+        self._stages, self._items, self._files = {}, {}, {}
+        return snapshot
+
+    def merge(self, snapshot: Optional[dict]) -> None:
+        """Add a snapshot drained by a worker process"""
+        if not snapshot or not self.enabled:
+            return
+        for name, (calls, seconds, max_seconds, peak_bytes) in snapshot["stages"].items():
+            stats = self._stages.setdefault(name, [0, 0.0, 0.0, 0])
+            stats[0] += calls
+            stats[1] += seconds
+            stats[2] = max(stats[2], max_seconds)
+            stats[3] = max(stats[3], peak_bytes)
+        for name, items in snapshot["items"].items():
+            target = self._items.setdefault(name, {})
+            for item, (seconds, peak_bytes) in items.items():
+                entry = target.setdefault(item, [0.0, 0])
+                entry[0] += seconds
+                entry[1] = max(entry[1], peak_bytes)
+        self._files.update(snapshot["files"])
+
+    def report(self, top_files: int = DEFAULT_TOP_FILES) -> dict:
+        """Build the JSON-serializable profile report"""
+        stages = [
+            {
+                "name": name,
+                "calls": int(calls),
+                "seconds": round(seconds, 6),
+                "max_seconds": round(max_seconds, 6),
+                "peak_bytes": int(peak_bytes),
+            }
+            for name, (calls, seconds, max_seconds, peak_bytes) in self._stages.items()
+        ]
+        items = {
+            name: [
+                {"name": item, "seconds": round(seconds, 6), "peak_bytes": int(peak_bytes)}
+                for item, (seconds, peak_bytes) in sorted(
+                    entries.items(), key=lambda entry: (-entry[1][0], entry[0])
+                )
+            ]
+            for name, entries in self._items.items()
+        }
+        slowest = sorted(
+            self._files.items(), key=lambda entry: (-entry[1]["seconds"], entry[0])
+        )[:max(0, top_files)]
+        slowest_files = []
+        for relative_path, record in slowest:
+            entry = {
+                "file": relative_path,
+                "seconds": round(record["seconds"], 6),
+                "peak_bytes": int(record["peak_bytes"]),
+            }
+            # Notes such as the token count, then the file's own stage times
+            entry.update(
+                (key, value) for key, value in record.items()
+                if key not in ("seconds", "peak_bytes", "stages")
+            )
+            entry["stages"] = {
+                name: round(seconds, 6) for name, seconds in record["stages"].items()
+            }
+            slowest_files.append(entry)
+        return {
+            "format": PROFILE_REPORT_FORMAT,
+            "version": PROFILE_REPORT_VERSION,
+            "tool_version": __version__,
+            "wall_seconds": round(time.perf_counter() - self._started, 6),
+            "memory_traced": self.trace_memory,
+            "files_parsed": len(self._files),
+            "stages": stages,
+            "items": items,
+            "slowest_files": slowest_files,
+        }
+
+    def write_report(self, output_file: str, top_files: int = DEFAULT_TOP_FILES) -> None:
+        """Write the profile report as JSON"""
+        with open(output_file, "w", encoding="utf-8") as f:
+            json.dump(self.report(top_files), f, indent=2)
+
+
+PROFILER = Profiler()
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+"""
+PlantUML image rendering stage.
+
+Renders the .puml diagrams of an output folder to PNG images next to them.
+Diagrams are handed to PlantUML in batches, one long-lived process per
+worker (or posted to a PlantUML server), by a bounded worker pool. A
+render manifest records the content hash each PNG was rendered from, so a
+diagram is only rendered again when its content changed.
+"""
+
+import json
+import logging
+import os
+import re
+import shlex
+import subprocess
+import urllib.error
+import urllib.request
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Sequence, Union
+
+from .generator import DIAGRAM_MANIFEST, DIAGRAM_MANIFEST_FORMAT, Generator, _file_sha256
+
+RENDER_MANIFEST = "render_manifest.json"
+RENDER_MANIFEST_FORMAT = "c2puml-render-manifest"
+RENDER_MANIFEST_VERSION = 1
+
+DEFAULT_RENDER_COMMAND = ["plantuml"]
+SERVER_TIMEOUT_SECONDS = 120
+
+# PlantUML reports syntax errors as "Error line N in file: <path>"
+_ERROR_FILE_RE = re.compile(r"Error line \d+ in file: (.+)")
+
+
+@dataclass
+class RenderSummary:
+    """Outcome of one render run, by .puml file name"""
+
+    rendered: List[str] = field(default_factory=list)
+    up_to_date: List[str] = field(default_factory=list)
+    failed: Dict[str, str] = field(default_factory=dict)
+
+
+class DiagramRenderer:
+    """Renders the diagrams of an output folder to PNG images
+
+    With a server URL every diagram is posted to the PlantUML server's /png
+    endpoint; otherwise the diagrams are split into one batch per worker and
+    each batch is rendered by a single PlantUML process (one JVM start per
+    batch instead of per diagram).
+    """
+
+    def __init__(
+        self,
+        command: Union[str, Sequence[str], None] = None,
+        server: str = "",
+        jobs: int = 1,
+    ):
+        if isinstance(command, str):
+            command = shlex.split(command)
+        self.command = list(command) if command else list(DEFAULT_RENDER_COMMAND)
+        self.server = (server or "").rstrip("/")
+        self.jobs = Generator._resolve_jobs(jobs)
+        self.logger = logging.getLogger(__name__)
+
+    @classmethod
+    def from_config(cls, config) -> "DiagramRenderer":
+        """Create a renderer from the render_* options of a Config"""
+        return cls(
+            command=getattr(config, "render_command", None),
+            server=getattr(config, "render_server", ""),
+            jobs=getattr(config, "render_jobs", 1),
+        )
+
+    def render(self, output_dir: str) -> RenderSummary:
+        """Render every diagram whose PNG is missing or older than its content"""
+        summary = RenderSummary()
+        hashes = self._diagram_hashes(output_dir)
+        previous = self._load_manifest(output_dir)
+
+        pending = []
+        for name, content_hash in sorted(hashes.items()):
+            png_path = os.path.join(output_dir, name[: -len(".puml")] + ".png")
+            if previous.get(name) == content_hash and os.path.exists(png_path):
+                summary.up_to_date.append(name)
+            else:
+                pending.append(name)
+
+        images = {name: previous[name] for name in summary.up_to_date}
+        if pending:
+            if self.server:
+                failures = self._render_with_server(output_dir, pending)
+            else:
+                failures = self._render_with_command(output_dir, pending)
+            for name in pending:
+                if name in failures:
+                    summary.failed[name] = failures[name]
+                else:
+                    summary.rendered.append(name)
+                    images[name] = hashes[name]
+
+        self._write_manifest(output_dir, images)
+        self.logger.info(
+            "Rendered %d diagram(s), %d up to date, %d failed",
+            len(summary.rendered),
+            len(summary.up_to_date),
+            len(summary.failed),
+        )
+        for name, error in sorted(summary.failed.items()):
+            self.logger.error("Failed to render %s: %s", name, error)
+        return summary
+
+    def _diagram_hashes(self, output_dir: str) -> Dict[str, str]:
+        """Return the content hash of every .puml file in output_dir
+
+        Hashes listed in the incremental output manifest are taken from it;
+        other diagrams are hashed from disk.
+        """
+        names = sorted(
+            entry for entry in os.listdir(output_dir) if entry.endswith(".puml")
+        ) if os.path.isdir(output_dir) else []
+        listed: Dict[str, str] = {}
+        try:
+            with open(os.path.join(output_dir, DIAGRAM_MANIFEST), "r", encoding="utf-8") as f:
+                manifest = json.load(f)
+            if manifest.get("format") == DIAGRAM_MANIFEST_FORMAT:
+                listed = dict(manifest.get("diagrams") or {})
+        except (OSError, ValueError):
+            pass
+
+        hashes = {}
+        for name in names:
+            content_hash = listed.get(name) or _file_sha256(os.path.join(output_dir, name))
+            if content_hash:
+                hashes[name] = content_hash
+        return hashes
+
+    @staticmethod
+    def _load_manifest(output_dir: str) -> Dict[str, str]:
+        try:
+            with open(os.path.join(output_dir, RENDER_MANIFEST), "r", encoding="utf-8") as f:
+                manifest = json.load(f)
+        except (OSError, ValueError):
+            return {}
+        if manifest.get("format") != RENDER_MANIFEST_FORMAT:
+            return {}
+        return dict(manifest.get("images") or {})
+
+    @staticmethod
+    def _write_manifest(output_dir: str, images: Dict[str, str]) -> None:
+        manifest = {
+            "format": RENDER_MANIFEST_FORMAT,
+            "version": RENDER_MANIFEST_VERSION,
+            "images": dict(sorted(images.items())),
+        }
+        with open(os.path.join(output_dir, RENDER_MANIFEST), "w", encoding="utf-8") as f:
+            json.dump(manifest, f, indent=2)
+
+    def _render_with_command(self, output_dir: str, names: List[str]) -> Dict[str, str]:
+        """Render the diagrams with one PlantUML process per batch; returns failures"""
+        workers = min(self.jobs, len(names))
+        batches = [names[index::workers] for index in range(workers)]
+        failures: Dict[str, str] = {}
+        with ThreadPoolExecutor(max_workers=workers) as executor:
+            for batch_failures in executor.map(
+                lambda batch: self._render_batch(output_dir, batch), batches
+            ):
+                failures.update(batch_failures)
+        return failures
+
+    def _render_batch(self, output_dir: str, names: List[str]) -> Dict[str, str]:
+        paths = [os.path.abspath(os.path.join(output_dir, name)) for name in names]
+        png_paths = [path[: -len(".puml")] + ".png" for path in paths]
+        # Stale images must not count as rendered
+        for png_path in png_paths:
+            if os.path.exists(png_path):
+                os.remove(png_path)
+
+        try:
+            result = subprocess.run(
+                self.command + ["-tpng", "-charset", "UTF-8"] + paths,
+                capture_output=True,
+                text=True,
+            )
+        except OSError as e:
+            return {name: f"cannot run {self.command[0]}: {e}" for name in names}
+
+        failures: Dict[str, str] = {}
+        erroneous = set()
+        if result.returncode != 0:
+            for match in _ERROR_FILE_RE.finditer(result.stderr + result.stdout):
+                erroneous.add(os.path.abspath(match.group(1).strip()))
+        error = (result.stderr or result.stdout).strip().splitlines()
+        message = error[-1] if error else f"exit code {result.returncode}"
+        for name, path, png_path in zip(names, paths, png_paths):
+            if not os.path.exists(png_path):
+                failures[name] = message
+            elif path in erroneous or (result.returncode != 0 and not erroneous):
+                failures[name] = message
+        return failures
+
+    def _render_with_server(self, output_dir: str, names: List[str]) -> Dict[str, str]:
+        """Post the diagrams to the PlantUML server concurrently; returns failures"""
+        failures: Dict[str, str] = {}
+        with ThreadPoolExecutor(max_workers=min(self.jobs, len(names))) as executor:
+            for name, error in zip(
+                names, executor.map(lambda name: self._post(output_dir, name), names)
+            ):
+                if error is not None:
+                    failures[name] = error
+        return failures
+
+    def _post(self, output_dir: str, name: str) -> Optional[str]:
+        puml_path = os.path.join(output_dir, name)
+        png_path = puml_path[: -len(".puml")] + ".png"
+        try:
+            with open(puml_path, "rb") as f:
+                content = f.read()
+            request = urllib.request.Request(
+                f"{self.server}/png",
+                data=content,
+                headers={"Content-Type": "text/plain; charset=utf-8"},
+                method="POST",
+            )
+            with urllib.request.urlopen(request, timeout=SERVER_TIMEOUT_SECONDS) as response:
+                image = response.read()
+            with open(png_path + ".tmp", "wb") as f:
+                f.write(image)
+            os.replace(png_path + ".tmp", png_path)
+        except (OSError, urllib.error.URLError) as e:
+            return str(e)
+        return None
@@ -0,0 +1,322 @@
+#!/usr/bin/env python3
+"""
+Sharded runs for distributed CI.
+
+A ShardPlan partitions a project deterministically: every root .c file is
+assigned to one of N shards, balanced by the size of the sources in its
+include closure, and each shard parses its root files, the sources they
+include (transitively) and every header. Headers are parsed by all shards
+because diagrams mark functions and globals public by the declarations of
+any project header. Each file of the project is owned by exactly one shard,
+which provides it to the merged model. Every runner computes the same plan
+from the same tree.
+
+A shard run writes its model fragments, the diagrams of the root files it
+owns and a shard manifest to <output_dir>/shards/shard-K-of-N. ShardMerger
+combines the shard folders into one model.json and model_transformed.json,
+copies the diagrams into the output folder and writes one diagram index
+(diagram_manifest.json).
+"""
+
+import hashlib
+import json
+import logging
+import os
+import re
+import shutil
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Dict, FrozenSet, Iterable, List, Set, Tuple
+
+from ..models import ProjectModel
+from .preprocessor import HEADER_EXTENSIONS
+from .generator import (
+    DIAGRAM_MANIFEST,
+    DIAGRAM_MANIFEST_FORMAT,
+    DIAGRAM_MANIFEST_VERSION,
+    OUTPUT_PATTERNS,
+    _file_sha256,
+)
+
+SHARDS_DIR = "shards"
+SHARD_MANIFEST = "shard_manifest.json"
+SHARD_MANIFEST_FORMAT = "c2puml-shard-manifest"
+SHARD_MANIFEST_VERSION = 1
+
+# #include lines, read without parsing; a conditional include counts as well
+_INCLUDE_LINE_RE = re.compile(rb'^[ \t]*#[ \t]*include[ \t]*[<"]([^>"\r\n]+)[>"]', re.MULTILINE)
+
+
+def parse_shard_spec(spec: str) -> Tuple[int, int]:
+    """Parse a K/N shard specification into (index, count), index starting at 1"""
+    try:
+        index_text, count_text = spec.split("/")
+        index, count = int(index_text), int(count_text)
+    except ValueError:
+        raise ValueError(f"Invalid shard '{spec}', expected K/N such as 2/8")
+    if count < 1 or not 1 <= index <= count:
+        raise ValueError(f"Invalid shard '{spec}', K must be between 1 and N")
+    return index, count
+
+
+def shard_folder(output_dir: str, index: int, count: int) -> str:
+    """Return the folder a shard run writes to"""
+    return os.path.join(output_dir, SHARDS_DIR, f"shard-{index}-of-{count}")
+
+
+class ShardPlan:
+    """Assignment of the project files to shards, keyed by file name"""
+
+    def __init__(self, count: int, owners: Dict[str, int], needed: List[FrozenSet[str]]):
+        self.count = count
+        # File name -> shard (1-based) whose fragment provides the file
+        self.owners = owners
+        # Per shard: the file names it parses
+        self.needed = needed
+        data = json.dumps([count, sorted(owners.items())], ensure_ascii=False)
+        self.fingerprint = hashlib.sha256(data.encode("utf-8")).hexdigest()
+
+    @classmethod
+    def build(cls, paths: Iterable[Path], count: int) -> "ShardPlan":
+        """Plan the shards of the discovered files of all source folders"""
+        by_name: Dict[str, List[Path]] = {}
+        for path in paths:
+            by_name.setdefault(path.name, []).append(path)
+
+        sizes: Dict[str, int] = {}
+        includes: Dict[str, Set[str]] = {}
+        for name, name_paths in by_name.items():
+            sizes[name] = 0
+            includes[name] = set()
+            for path in name_paths:
+                try:
+                    with open(path, "rb") as f:
+                        data = f.read()
+                except OSError:
+                    continue
+                sizes[name] += len(data)
+                for match in _INCLUDE_LINE_RE.finditer(data):
+                    include = match.group(1).decode("utf-8", "replace").strip()
+                    # The model resolves includes by file name; keep both spellings
+                    for candidate in (include, os.path.basename(include)):
+                        if candidate in by_name and candidate != name:
+                            includes[name].add(candidate)
+
+        def closure(root: str) -> Set[str]:
+            reached = {root}
+            pending = [root]
+            while pending:
+                for include in includes[pending.pop()]:
+                    if include not in reached:
+                        reached.add(include)
+                        pending.append(include)
+            return reached
+
+        roots = [name for name in by_name if name.endswith(".c")]
+        headers = {name for name in by_name if name.endswith(HEADER_EXTENSIONS)}
+        closures = {root: closure(root) for root in roots}
+        costs = {
+            root: sum(sizes[name] for name in closures[root] if name not in headers)
+            for root in roots
+        }
+
+        # Largest closures first, each to the least loaded shard
+        loads = [0] * count
+        needed: List[Set[str]] = [set(headers) for _ in range(count)]
+        owners: Dict[str, int] = {}
+        for root in sorted(roots, key=lambda name: (-costs[name], name)):
+            shard = min(range(count), key=lambda index: (loads[index], index))
+            owners[root] = shard + 1
+            needed[shard].update(closures[root])
+            loads[shard] += costs[root]
+
+        # Every shard parses the headers; shard 1 provides them. Other files
+        # come from the first shard that includes them, or the least loaded one
+        for name in sorted(by_name):
+            if name in owners:
+                continue
+            if name in headers:
+                owners[name] = 1
+                continue
+            containing = [index for index in range(count) if name in needed[index]]
+            if containing:
+                owners[name] = containing[0] + 1
+            else:
+                shard = min(range(count), key=lambda index: (loads[index], index))
+                owners[name] = shard + 1
+                needed[shard].add(name)
+                loads[shard] += sizes[name]
+
+        return cls(count, owners, [frozenset(names) for names in needed])
+
+    def selection(self, index: int, paths: Iterable[Path]) -> Set[str]:
+        """Return the paths (as strings) shard index parses"""
+        needed = self.needed[index - 1]
+        return {str(path) for path in paths if path.name in needed}
+
+    def owned(self, index: int) -> Set[str]:
+        """Return the file names shard index provides to the merged model"""
+        return {name for name, owner in self.owners.items() if owner == index}
+
+    def write_manifest(
+        self, folder: str, index: int, model_name: str, transformed_model_name: str
+    ) -> None:
+        """Describe the output of shard index in its folder for the merge step"""
+        diagrams = {}
+        for entry in sorted(os.listdir(folder)):
+            if entry.endswith(".puml"):
+                digest = _file_sha256(os.path.join(folder, entry))
+                if digest:
+                    diagrams[entry] = digest
+        manifest = {
+            "format": SHARD_MANIFEST_FORMAT,
+            "version": SHARD_MANIFEST_VERSION,
+            "shard": index,
+            "count": self.count,
+            "fingerprint": self.fingerprint,
+            "model": model_name,
+            "transformed_model": transformed_model_name,
+            "owned": sorted(self.owned(index)),
+            "diagrams": diagrams,
+        }
+        with open(os.path.join(folder, SHARD_MANIFEST), "w", encoding="utf-8") as f:
+            json.dump(manifest, f, indent=2)
+
+
+@dataclass
+class MergeSummary:
+    """Outcome of merging the shard folders"""
+
+    shards: int = 0
+    files: int = 0
+    diagrams: Dict[str, int] = field(default_factory=dict)
+    changed: List[str] = field(default_factory=list)
+    removed: List[str] = field(default_factory=list)
+
+
+class ShardMerger:
+    """Combines the shard folders of an output folder into one output"""
+
+    def __init__(self, output_dir: str):
+        self.output_dir = output_dir
+        self.logger = logging.getLogger(__name__)
+
+    def merge(self, model_file: str, transformed_model_file: str) -> MergeSummary:
+        """Write the merged models, diagrams and diagram index
+
+        Raises ValueError when shards are missing or were planned differently.
+        """
+        manifests = self._load_manifests()
+        owners: Dict[str, int] = {}
+        for folder, manifest in manifests:
+            for name in manifest["owned"]:
+                owners[name] = manifest["shard"]
+
+        summary = MergeSummary(shards=len(manifests))
+        model = self._merge_models(manifests, owners, "model")
+        # Uses are recomputed over the whole project, as the parse step does
+        model.update_uses_fields()
+        model.save(model_file)
+        summary.files = len(model.files)
+        self._merge_models(manifests, owners, "transformed_model").save(transformed_model_file)
+
+        for folder, manifest in manifests:
+            for name, digest in sorted(manifest["diagrams"].items()):
+                summary.diagrams[name] = manifest["shard"]
+                target = os.path.join(self.output_dir, name)
+                if _file_sha256(target) == digest:
+                    continue
+                shutil.copyfile(os.path.join(folder, name), target + ".tmp")
+                os.replace(target + ".tmp", target)
+                summary.changed.append(name)
+
+        self._remove_orphans(summary)
+        self._write_index(manifests, summary)
+        self.logger.info(
+            "Merged %d shards: %d files, %d diagrams (%d changed, %d removed)",
+            summary.shards,
+            summary.files,
+            len(summary.diagrams),
+            len(summary.changed),
+            len(summary.removed),
+        )
+        return summary
+
+    def _load_manifests(self) -> List[Tuple[str, dict]]:
+        shards_dir = os.path.join(self.output_dir, SHARDS_DIR)
+        manifests = []
+        entries = sorted(os.listdir(shards_dir)) if os.path.isdir(shards_dir) else []
+        for entry in entries:
+            path = os.path.join(shards_dir, entry, SHARD_MANIFEST)
+            try:
+                with open(path, "r", encoding="utf-8") as f:
+                    manifest = json.load(f)
+            except FileNotFoundError:
+                continue
+            except (OSError, ValueError) as e:
+                raise ValueError(f"Cannot read shard manifest {path}: {e}")
+            if manifest.get("format") != SHARD_MANIFEST_FORMAT:
+                raise ValueError(f"Not a shard manifest: {path}")
+            manifests.append((os.path.join(shards_dir, entry), manifest))
+        if not manifests:
+            raise ValueError(f"No shard output found in {shards_dir}")
+
+        count = manifests[0][1]["count"]
+        fingerprint = manifests[0][1]["fingerprint"]
+        for _, manifest in manifests:
+            if manifest["count"] != count or manifest["fingerprint"] != fingerprint:
+                raise ValueError(
+                    "Shard outputs come from different plans (shard count or source files differ)"
+                )
+        found = sorted(manifest["shard"] for _, manifest in manifests)
+        if found != list(range(1, count + 1)):
+            missing = sorted(set(range(1, count + 1)) - set(found))
+            raise ValueError(f"Missing shard output for shard(s) {missing} of {count}")
+        return sorted(manifests, key=lambda item: item[1]["shard"])
+
+    @staticmethod
+    def _merge_models(
+        manifests: List[Tuple[str, dict]], owners: Dict[str, int], kind: str
+    ) -> ProjectModel:
+        """Combine the fragments of one kind, taking each file from its owning shard"""
+        files = {}
+        project_name = source_folder = None
+        for folder, manifest in manifests:
+            fragment = ProjectModel.load(os.path.join(folder, manifest[kind]))
+            project_name = project_name or fragment.project_name
+            source_folder = source_folder or fragment.source_folder
+            for name in fragment.files:
+                if owners.get(name) == manifest["shard"]:
+                    files[name] = fragment.files[name]
+        return ProjectModel(
+            project_name=project_name, source_folder=source_folder, files=dict(sorted(files.items()))
+        )
+
+    def _remove_orphans(self, summary: MergeSummary) -> None:
+        """Delete outputs of diagrams that no shard produced any more"""
+        current_stems = {Path(name).stem for name in summary.diagrams}
+        for pattern in OUTPUT_PATTERNS:
+            for entry in sorted(os.listdir(self.output_dir)):
+                if not Path(entry).match(pattern) or Path(entry).stem in current_stems:
+                    continue
+                try:
+                    os.remove(os.path.join(self.output_dir, entry))
+                except OSError:
+                    continue
+                if entry.endswith(".puml"):
+                    summary.removed.append(entry)
+
+    def _write_index(self, manifests: List[Tuple[str, dict]], summary: MergeSummary) -> None:
+        diagrams = {}
+        for _, manifest in manifests:
+            diagrams.update(manifest["diagrams"])
+        index = {
+            "format": DIAGRAM_MANIFEST_FORMAT,
+            "version": DIAGRAM_MANIFEST_VERSION,
+            "diagrams": dict(sorted(diagrams.items())),
+            "changed": sorted(summary.changed),
+            "removed": sorted(summary.removed),
+            "shards": dict(sorted(summary.diagrams.items())),
+        }
+        with open(os.path.join(self.output_dir, DIAGRAM_MANIFEST), "w", encoding="utf-8") as f:
+            json.dump(index, f, indent=2)
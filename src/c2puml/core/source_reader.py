@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+Source file ingestion for the C to PlantUML converter.
+
+Reads every source file exactly once as bytes (optionally through mmap for
+large files), detects the encoding from that buffer, decodes it with the same
+newline handling as text mode and keeps byte and read-time counters.
+"""
+
+import mmap
+import os
+import time
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Dict, Optional
+
+from ..utils import detect_encoding_from_bytes
+from .parse_cache import ParseCache
+
+
+@dataclass
+class SourceText:
+    """Decoded content of one source file"""
+
+    content: str
+    encoding: str
+    size: int
+    read_seconds: float
+    content_hash: Optional[str] = None
+
+
+class SourceReader:
+    """Reads source files once and decodes them from the in-memory buffer"""
+
+    def __init__(self, mmap_threshold: int = 0):
+        # Files of at least this many bytes are mapped instead of read (0 disables mmap)
+        self.mmap_threshold = mmap_threshold
+        self.files_read = 0
+        self.bytes_read = 0
+        self.read_seconds = 0.0
+
+    def read(self, file_path: Path, with_hash: bool = False) -> SourceText:
+        """Read, detect and decode a file; optionally hash the raw bytes too"""
+        start = time.perf_counter()
+        with open(file_path, "rb") as f:
+            size = os.fstat(f.fileno()).st_size
+            if self.mmap_threshold > 0 and size >= self.mmap_threshold:
+                with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+                    text = self._decode(data, size, with_hash)
+            else:
+                data = f.read()
+                size = len(data)
+                text = self._decode(data, size, with_hash)
+        text.read_seconds = time.perf_counter() - start
+        self.record(text.size, text.read_seconds)
+        return text
+
+    @staticmethod
+    def _decode(data, size: int, with_hash: bool) -> SourceText:
+        """Decode a bytes-like buffer the way text mode would read it"""
+        encoding = detect_encoding_from_bytes(data[:8192], final=size <= 8192)
+        content = str(data, encoding)
+        # Universal newlines, as applied by open(..., "r")
+        if "\r" in content:
+            content = content.replace("\r\n", "\n").replace("\r", "\n")
+        content_hash = ParseCache.hash_bytes(data) if with_hash else None
+        return SourceText(content, encoding, size, 0.0, content_hash)
+
+    def record(self, size: int, read_seconds: float) -> None:
+        """Count a file read (also used for reads done by worker processes)"""
+        self.files_read += 1
+        self.bytes_read += size
+        self.read_seconds += read_seconds
+
+    def stats(self) -> Dict[str, float]:
+        """Return the I/O counters"""
+        return {
+            "files_read": self.files_read,
+            "bytes_read": self.bytes_read,
+            "read_seconds": self.read_seconds,
+        }
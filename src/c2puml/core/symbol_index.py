@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""
+Project-level symbol index for the C to PlantUML converter.
+
+Collects the project-wide lookups that are otherwise recomputed per diagram or
+per transformation pass (header declarations, globals, typedef ownership,
+filename to key maps and anonymous structure relations). The index is built
+once per ProjectModel and cached on it; it is rebuilt when model.files is
+replaced or changes size, and callers that edit files in place call
+invalidate().
+"""
+
+from pathlib import Path
+from typing import Dict, List, Optional, Set, Tuple
+
+from ..models import FileModel, ProjectModel
+
+# Attribute used to cache the index on a ProjectModel instance
+_INDEX_ATTR = "_symbol_index"
+
+TYPEDEF_COLLECTIONS = ("structs", "enums", "unions", "aliases")
+
+
+class ProjectSymbolIndex:
+    """Read-only project-wide symbol lookups derived from a ProjectModel"""
+
+    def __init__(self, model: ProjectModel):
+        self._files = model.files
+        self._file_keys = frozenset(model.files)
+
+        # Names declared by headers (public in diagrams)
+        self.header_function_decl_names: Set[str] = set()
+        self.header_global_names: Set[str] = set()
+        # First file (in sorted key order) defining each typedef-like name
+        self.typedef_owners: Dict[str, str] = {}
+        # Basename of FileModel.name -> FileModel (last one wins, as in a dict build)
+        self.files_by_filename: Dict[str, FileModel] = {}
+        # Basename of model key -> model key
+        self.key_by_filename: Dict[str, str] = {}
+        # Anonymous structure relations in model iteration order
+        self.anonymous_relationships: List[Tuple[str, str, List[str]]] = []
+        self.anonymous_children: Set[str] = set()
+        self.anonymous_pairs: Set[Tuple[str, str]] = set()
+
+        self._basenames: Dict[str, str] = {}
+
+        for key, file_model in model.files.items():
+            self.files_by_filename[self.basename(file_model.name)] = file_model
+            self.key_by_filename.setdefault(self.basename(key), key)
+
+            if key.endswith(".h"):
+                for func in file_model.functions:
+                    if func.is_declaration:
+                        self.header_function_decl_names.add(func.name)
+                for global_var in file_model.globals:
+                    self.header_global_names.add(global_var.name)
+
+            for parent_name, children in (file_model.anonymous_relationships or {}).items():
+                self.anonymous_relationships.append((key, parent_name, children))
+                for child_name in children:
+                    self.anonymous_children.add(child_name)
+                    self.anonymous_pairs.add((parent_name, child_name))
+
+        for key in sorted(model.files):
+            file_model = model.files[key]
+            for collection_name in TYPEDEF_COLLECTIONS:
+                for typedef_name in getattr(file_model, collection_name):
+                    self.typedef_owners.setdefault(typedef_name, key)
+
+    @classmethod
+    def for_model(cls, model: ProjectModel) -> "ProjectSymbolIndex":
+        """Return the cached index of a model, building it when missing or stale"""
+        index = model.__dict__.get(_INDEX_ATTR)
+        if index is None or not index.is_current(model):
+            index = cls(model)
+            model.__dict__[_INDEX_ATTR] = index
+        return index
+
+    @staticmethod
+    def invalidate(model: ProjectModel) -> None:
+        """Drop the cached index after a model has been edited in place"""
+        model.__dict__.pop(_INDEX_ATTR, None)
+
+    def is_current(self, model: ProjectModel) -> bool:
+        """Return True if the index was built for the model's current file set"""
+        return model.files is self._files and len(model.files) == len(self._file_keys)
+
+    def basename(self, file_name: str) -> str:
+        """Return Path(file_name).name, memoized"""
+        name = self._basenames.get(file_name)
+        if name is None:
+            name = Path(file_name).name
+            self._basenames[file_name] = name
+        return name
+
+    def find_file_key(self, file_name: str) -> str:
+        """Return the model key for a file name or include path
+
+        Exact keys are returned unchanged; otherwise the basename is returned
+        (filenames are the model keys, so callers check membership afterwards).
+        """
+        if file_name in self._file_keys:
+            return file_name
+        return self.basename(file_name)
+
+    def typedef_owner(self, typedef_name: str) -> Optional[str]:
+        """Return the key of the file that defines a typedef-like name"""
+        return self.typedef_owners.get(typedef_name)
+
+    def is_anonymous_structure(self, typedef_name: str) -> bool:
+        """Return True if the name is a child in any anonymous relationship"""
+        return typedef_name in self.anonymous_children
+
+    def is_anonymous_composition_pair(self, parent_name: str, child_name: str) -> bool:
+        """Return True if a parent->child anonymous composition exists"""
+        return (parent_name, child_name) in self.anonymous_pairs
@@ -18,8 +18,14 @@ from ..models import (
 	IncludeRelation,
 	ProjectModel,
 	Struct,
+	TypeReferenceIndex,
 	Union,
 )
+from .include_graph import IncludeGraph
+from .pattern_engine import PatternEngine, PatternMatcher
+from .profiler import PROFILER
+from .symbol_index import ProjectSymbolIndex
+from .type_reference_map import CLEANUP_KINDS, TypeReferenceMap, describe_slot
 
 
 class Transformer:
@@ -27,6 +33,12 @@ class Transformer:
 
 	def __init__(self) -> None:
 		self.logger = logging.getLogger(__name__)
+		self.patterns = PatternEngine(self.logger)
+		# Set while transformation containers run; keeps "uses" in sync with edits
+		self._type_index: Optional[TypeReferenceIndex] = None
+		self._type_map: Optional[TypeReferenceMap] = None
+		# Files whose elements the current container removed or renamed
+		self._changed_files: Set[str] = set()
 
 	def transform(
 		self, model_file: str, config_file: str, output_file: Optional[str] = None
@@ -35,9 +47,7 @@ class Transformer:
 		self.logger.info("Step 2: Transforming model: %s", model_file)
 
 		model = self._load_model(model_file)
-		config = self._load_config(config_file)
-
-		transformed_model = self._apply_transformations(model, config)
+		transformed_model = self.transform_model(model, config_file)
 
 		output_path = output_file or model_file
 		self._save_model(transformed_model, output_path)
@@ -45,6 +55,12 @@ class Transformer:
 		self.logger.info("Step 2 complete! Transformed model saved to: %s", output_path)
 		return output_path
 
+	@PROFILER.profiled("transform")
+	def transform_model(self, model: ProjectModel, config_file: str) -> ProjectModel:
+		""""""
+		config = self._load_config(config_file)
+		return self._apply_transformations(model, config)
+
 	def _load_model(self, model_file: str) -> ProjectModel:
 		""""""
 		model_path = Path(model_file)
@@ -83,14 +99,18 @@ class Transformer:
 		self.logger.info("Applying transformations to model")
 
 		if "file_filters" in config:
-			model = self._apply_file_filters(model, config["file_filters"])
+			with PROFILER.stage("transform.file_filters"):
+				model = self._apply_file_filters(model, config["file_filters"])
 
 		config = self._ensure_backward_compatibility(config)
 
 		model = self._apply_transformation_containers(model, config)
+		# Containers edit file models in place; later lookups need a fresh index
+		ProjectSymbolIndex.invalidate(model)
 
 		if self._should_process_include_relations(config):
-			model = self._process_include_relations_simplified(model, config)
+			with PROFILER.stage("transform.include_processing"):
+				model = self._process_include_relations_simplified(model, config)
 
 		self.logger.info(
 			"Transformations complete. Model now has %d files", len(model.files)
@@ -106,12 +126,19 @@ class Transformer:
 		if not transformation_containers:
 			return model
 			
-		for container_name, transformation_config in transformation_containers:
-			self.logger.info("Applying transformation container: %s", container_name)
-			model = self._apply_single_transformation_container(
-				model, transformation_config, container_name
-			)
-			self._log_model_state_after_container(model, container_name)
+		self._type_index = TypeReferenceIndex.build(model)
+		self._type_map = TypeReferenceMap()
+		try:
+			for container_name, transformation_config in transformation_containers:
+				self.logger.info("Applying transformation container: %s", container_name)
+				with PROFILER.stage("transform.container", item=container_name):
+					model = self._apply_single_transformation_container(
+						model, transformation_config, container_name
+					)
+				self._log_model_state_after_container(model, container_name)
+		finally:
+			self._type_index = None
+			self._type_map = None
 				
 		return model
 
@@ -189,13 +216,31 @@ class Transformer:
 		self.logger.debug("Processing transformation container: %s", container_name)
 		
 		target_files = self._get_target_files(model, transformation_config)
+		self._changed_files = set()
 		
 		model = self._apply_remove_operations(model, transformation_config, target_files, container_name)
 		model = self._apply_rename_operations(model, transformation_config, target_files, container_name)
 		model = self._apply_add_operations(model, transformation_config, target_files, container_name)
 		
+		self._refresh_type_references(model, self._changed_files)
+		
 		return model
 
+	def _refresh_type_references(self, model: ProjectModel, file_keys: Set[str]) -> None:
+		""""""
+		if self._type_map is not None:
+			# Renames replace element objects, so re-index these files on next use
+			self._type_map.invalidate(file_keys)
+		if self._type_index is None:
+			return
+		updated = self._type_index.refresh(model, file_keys)
+		if updated:
+			self.logger.debug("Updated uses of %d typedefs", updated)
+
+	def _mark_changed(self, file_name: str) -> None:
+		""""""
+		self._changed_files.add(file_name)
+
 	def _get_target_files(
 		self, model: ProjectModel, transformation_config: Dict[str, Any]
 	) -> Set[str]:
@@ -222,12 +267,8 @@ class Transformer:
 		self, model: ProjectModel, patterns: List[str]
 	) -> Set[str]:
 		""""""
-		target_files = set()
-		for pattern in patterns:
-			for file_path in model.files.keys():
-				if self._matches_pattern(file_path, pattern):
-					target_files.add(file_path)
-		return target_files
+		matcher = self.patterns.matcher(patterns)
+		return {file_path for file_path in model.files.keys() if matcher.matches(file_path)}
 
 	def _apply_remove_operations(
 		self, 
@@ -247,10 +288,14 @@ class Transformer:
 		)
 		
 		model = self._apply_removals(model, transformation_config["remove"], target_files)
+		if self._type_map is not None:
+			self._type_map.invalidate(self._changed_files)
 		
 		if removed_typedef_names:
 			self.logger.debug("Calling type reference cleanup for container: %s", container_name)
-			self._cleanup_type_references_by_names(model, removed_typedef_names)
+			cleaned_files = self._cleanup_type_references_by_names(model, removed_typedef_names)
+			if self._type_index is not None:
+				self._type_index.invalidate(cleaned_files)
 			
 		return model
 
@@ -295,16 +340,16 @@ class Transformer:
 			return removed_typedef_names
 			
 		typedef_patterns = remove_config["typedef"]
-		compiled_patterns = self._compile_patterns(typedef_patterns)
+		matcher = self.patterns.matcher(typedef_patterns)
 		
-		if not compiled_patterns:
+		if not matcher.has_patterns:
 			return removed_typedef_names
 			
 		for file_path in target_files:
 			if file_path in model.files:
 				file_model = model.files[file_path]
 				for alias_name in file_model.aliases.keys():
-					if self._matches_any_pattern(alias_name, compiled_patterns):
+					if matcher.matches(alias_name):
 						removed_typedef_names.add(alias_name)
 						
 		self.logger.debug("Pre-identified typedefs for removal: %s", list(removed_typedef_names))
@@ -327,10 +372,9 @@ class Transformer:
 		for file_model in model.files.values():
 			file_model.include_relations = []
 		
-		file_map = {}
-		for file_model in model.files.values():
-			filename = Path(file_model.name).name
-			file_map[filename] = file_model
+		file_map = ProjectSymbolIndex.for_model(model).files_by_filename
+		# Built once; closures of shared header chains are reused by every root
+		include_graph = IncludeGraph(file_map)
 		
 		c_files = sorted([
 			fm for fm in model.files.values() if fm.name.endswith(".c")
@@ -338,7 +382,7 @@ class Transformer:
 		
 		for root_file in c_files:
 			self._process_root_c_file_includes(
-				root_file, file_map, global_include_depth, file_specific_config, include_filter_local_only, always_show_includes
+				root_file, include_graph, global_include_depth, file_specific_config, include_filter_local_only, always_show_includes
 			)
 			
 		return model
@@ -346,7 +390,7 @@ class Transformer:
 	def _process_root_c_file_includes(
 		self, 
 		root_file: FileModel, 
-		file_map: Dict[str, FileModel],
+		include_graph: IncludeGraph,
 		global_include_depth: int,
 		file_specific_config: Dict[str, Any],
 		include_filter_local_only: bool,
@@ -361,7 +405,7 @@ class Transformer:
 		if root_filename in file_specific_config:
 			file_config = file_specific_config[root_filename]
 			include_depth = file_config.get("include_depth", global_include_depth)
-			include_filters = file_config.get("include_filter", [])
+			include_filters = list(file_config.get("include_filter", []))
 		
 		if include_filter_local_only:
 			local_header_pattern = f"^{Path(root_filename).stem}\\.h$"
@@ -375,122 +419,47 @@ class Transformer:
 			)
 			return
 			
-		compiled_filters = []
 		if include_filters:
 			try:
-				compiled_filters = [re.compile(pattern) for pattern in include_filters]
-				self.logger.debug(
-					"Compiled %d filter patterns for %s", 
-					len(compiled_filters), root_filename
-				)
+				for pattern in include_filters:
+					re.compile(pattern)
 			except re.error as e:
 				self.logger.warning(
 					"Invalid regex pattern for %s: %s", root_filename, e
 				)
+				include_filters = []
+		matcher = self.patterns.matcher(include_filters) if include_filters else None
 		
 		self.logger.debug(
 			"Processing includes for root C file %s (depth=%d, filters=%d)",
-			root_filename, include_depth, len(compiled_filters)
+			root_filename, include_depth, len(include_filters)
 		)
 		
-		processed_files = set()
 		try:
 			root_file.placeholder_headers.clear()
 		except Exception:
 			root_file.placeholder_headers = set()
 		
-		current_level = [root_file]
+		# Files reachable through included (not filtered) headers, with their
+		# shortest include distance; filtered includes stay leaf relations
+		distances = include_graph.view(tuple(include_filters), matcher).closure(
+			root_filename, include_depth - 1
+		)
 		
-		for depth in range(1, include_depth + 1):
-			next_level = []
-			
-			self.logger.debug(
-				"Processing depth %d for %s (%d files at current level)",
-				depth, root_filename, len(current_level)
-			)
-			
-			for current_file in sorted(current_level, key=lambda fm: Path(fm.name).name):
-				current_filename = Path(current_file.name).name
-				
-				if current_filename in processed_files:
-					continue
-				processed_files.add(current_filename)
-				
-				for include_name in sorted(current_file.includes):
-					filtered_out_by_patterns = False
-					if compiled_filters:
-						if not any(pattern.search(include_name) for pattern in compiled_filters):
-							if always_show_includes:
-								filtered_out_by_patterns = True
-								self.logger.debug(
-									"Include %s filtered by patterns at depth %d for %s, but will be shown as placeholder",
-									include_name, depth, root_filename
-								)
-								# Intentionally do not continue here; still add relation and mark placeholder
-							else:
-								self.logger.debug(
-									"Filtered out include %s at depth %d for %s",
-									include_name, depth, root_filename
-								)
-								continue
-					
-					if include_name not in file_map:
-						self.logger.debug(
-							"Include %s not found in project files (depth %d, root %s)",
-							include_name, depth, root_filename
-						)
+		for source_file in sorted(distances, key=lambda name: (distances[name], name)):
+			depth = distances[source_file] + 1
+			for include_name in include_graph.adjacency.get(source_file, ()):
+				if matcher is not None and not matcher.matches(include_name):
+					if not always_show_includes:
 						continue
-					
-					if include_name == current_filename:
-						self.logger.debug(
-							"Skipping self-reference %s at depth %d for %s",
-							include_name, depth, root_filename
-						)
-						continue
-					
-					existing_relation = any(
-						rel.source_file == current_filename and rel.included_file == include_name
-						for rel in root_file.include_relations
-					)
-					
-					if existing_relation:
-						self.logger.debug(
-							"Skipping duplicate relation %s -> %s for %s",
-							current_filename, include_name, root_filename
-						)
-						continue
-					
-					relation = IncludeRelation(
-						source_file=current_filename,
+					root_file.placeholder_headers.add(include_name)
+				root_file.include_relations.append(
+					IncludeRelation(
+						source_file=source_file,
 						included_file=include_name,
 						depth=depth
 					)
-					root_file.include_relations.append(relation)
-					
-					self.logger.debug(
-						"Added include relation: %s -> %s (depth %d) for root %s",
-						current_filename, include_name, depth, root_filename
-					)
-					
-					if filtered_out_by_patterns:
-						try:
-							root_file.placeholder_headers.add(include_name)
-						except Exception:
-							root_file.placeholder_headers = {include_name}
-						continue
-					
-					included_file = file_map[include_name]
-					if included_file not in next_level and include_name not in processed_files:
-						next_level.append(included_file)
-			
-			current_level = sorted(next_level, key=lambda fm: Path(fm.name).name)
-			
-			if not current_level:
-				self.logger.debug(
-					"No more files to process at depth %d for %s", 
-					depth + 1, root_filename
 				)
-				break
 		
 		self.logger.debug(
 			"Completed include processing for %s: %d relations generated",
@@ -647,14 +616,6 @@ class Transformer:
 		""""""
 		return any(pattern.search(text) for pattern in patterns)
 	
-	def _matches_pattern(self, text: str, pattern: str) -> bool:
-		""""""
-		try:
-			return bool(re.search(pattern, text))
-		except re.error as e:
-			self.logger.warning("Invalid regex pattern '%s': %s", pattern, e)
-			return False
-
 	# Removed unused _apply_model_transformations (legacy API)
 
 	def _apply_renaming(
@@ -706,8 +667,8 @@ class Transformer:
 			self.logger.debug("No typedef patterns to clean up")
 			return
 			
-		compiled_patterns = self._compile_patterns(removed_typedef_patterns)
-		if not compiled_patterns:
+		matcher = self.patterns.matcher(removed_typedef_patterns)
+		if not matcher.has_patterns:
 			self.logger.debug("No valid compiled patterns")
 			return
 			
@@ -718,68 +679,13 @@ class Transformer:
 				file_model = model.files[file_path]
 				
 				for alias_name in list(file_model.aliases.keys()):
-					if self._matches_any_pattern(alias_name, compiled_patterns):
+					if matcher.matches(alias_name):
 						removed_types.add(alias_name)
 						self.logger.debug("Found removed typedef: %s in file %s", alias_name, file_path)
 		
 		self.logger.debug("Total removed types identified: %s", list(removed_types))
 		
-		cleaned_count = 0
-		for file_path, file_model in model.files.items():
-			file_cleaned = 0
-			
-			for func in file_model.functions:
-				if func.return_type and self._contains_removed_type(func.return_type, removed_types):
-					old_type = func.return_type
-					func.return_type = self._remove_type_references(func.return_type, removed_types)
-					if func.return_type != old_type:
-						file_cleaned += 1
-						self.logger.debug(
-							"Cleaned return type '%s' -> '%s' in function %s", 
-							old_type, func.return_type, func.name
-						)
-				
-				for param in func.parameters:
-					if param.type and self._contains_removed_type(param.type, removed_types):
-						old_type = param.type
-						param.type = self._remove_type_references(param.type, removed_types)
-						if param.type != old_type:
-							file_cleaned += 1
-							self.logger.debug(
-								"Cleaned parameter type '%s' -> '%s' for parameter %s", 
-								old_type, param.type, param.name
-							)
-			
-			for global_var in file_model.globals:
-				if global_var.type and self._contains_removed_type(global_var.type, removed_types):
-					old_type = global_var.type
-					global_var.type = self._remove_type_references(global_var.type, removed_types)
-					if global_var.type != old_type:
-						file_cleaned += 1
-						self.logger.debug(
-							"Cleaned global variable type '%s' -> '%s' for %s", 
-							old_type, global_var.type, global_var.name
-						)
-			
-			for struct in file_model.structs.values():
-				for field in struct.fields:
-					if field.type and self._contains_removed_type(field.type, removed_types):
-						old_type = field.type
-						field.type = self._remove_type_references(field.type, removed_types)
-						if field.type != old_type:
-							file_cleaned += 1
-							self.logger.debug(
-								"Cleaned struct field type '%s' -> '%s' for %s.%s", 
-								old_type, field.type, struct.name, field.name
-							)
-			
-			cleaned_count += file_cleaned
-		
-		if cleaned_count > 0:
-			self.logger.info(
-				"Cleaned %d type references to removed typedefs: %s", 
-				cleaned_count, list(removed_types)
-			)
+		self._clean_removed_type_references(model, removed_types)
 		
 	def _contains_removed_type(self, type_str: str, removed_types: Set[str]) -> bool:
 		""""""
@@ -806,140 +712,76 @@ class Transformer:
 	
 	def _cleanup_type_references_by_names(
 		self, model: ProjectModel, removed_typedef_names: Set[str]
-	) -> None:
+	) -> Set[str]:
 		""""""
 		if not removed_typedef_names:
 			self.logger.debug("No removed typedef names provided")
-			return
+			return set()
 			
 		self.logger.debug("Cleaning type references for removed typedefs: %s", list(removed_typedef_names))
-		
+		return self._clean_removed_type_references(model, removed_typedef_names)
+
+	def _clean_removed_type_references(
+		self, model: ProjectModel, removed_types: Set[str]
+	) -> Set[str]:
+		""""""
 		cleaned_count = 0
-		for file_path, file_model in model.files.items():
+		cleaned_files = set()
+		type_map = self._type_references()
+		candidates = type_map.slots_containing(model, removed_types)
+		for file_path, slots in candidates.items():
 			file_cleaned = 0
 			
-			for func in file_model.functions:
-				if func.return_type and self._contains_removed_type(func.return_type, removed_typedef_names):
-					old_type = func.return_type
-					func.return_type = self._remove_type_references(func.return_type, removed_typedef_names)
-					if func.return_type != old_type:
-						file_cleaned += 1
-						self.logger.debug(
-							"Cleaned return type '%s' -> '%s' in function %s", 
-							old_type, func.return_type, func.name
-						)
-				
-				for param in func.parameters:
-					if param.type and self._contains_removed_type(param.type, removed_typedef_names):
-						old_type = param.type
-						param.type = self._remove_type_references(param.type, removed_typedef_names)
-						if param.type != old_type:
-							file_cleaned += 1
-							self.logger.debug(
-								"Cleaned parameter type '%s' -> '%s' for parameter %s", 
-								old_type, param.type, param.name
-							)
-			
-			for global_var in file_model.globals:
-				if global_var.type and self._contains_removed_type(global_var.type, removed_typedef_names):
-					old_type = global_var.type
-					global_var.type = self._remove_type_references(global_var.type, removed_typedef_names)
-					if global_var.type != old_type:
+			for slot in slots:
+				if slot.kind not in CLEANUP_KINDS:
+					continue
+				old_type = slot.value
+				if old_type and self._contains_removed_type(old_type, removed_types):
+					new_type = self._remove_type_references(old_type, removed_types)
+					if new_type != old_type:
+						type_map.set_type(slot, new_type)
 						file_cleaned += 1
 						self.logger.debug(
-							"Cleaned global variable type '%s' -> '%s' for %s", 
-							old_type, global_var.type, global_var.name
+							"Cleaned type '%s' -> '%s' for %s",
+							old_type, new_type, describe_slot(slot)
 						)
 			
-			for struct in file_model.structs.values():
-				for field in struct.fields:
-					if field.type and self._contains_removed_type(field.type, removed_typedef_names):
-						old_type = field.type
-						field.type = self._remove_type_references(field.type, removed_typedef_names)
-						if field.type != old_type:
-							file_cleaned += 1
-							self.logger.debug(
-								"Cleaned struct field type '%s' -> '%s' for %s.%s", 
-								old_type, field.type, struct.name, field.name
-							)
-			
 			cleaned_count += file_cleaned
 			if file_cleaned > 0:
+				cleaned_files.add(file_path)
 				self.logger.debug("Cleaned %d type references in file %s", file_cleaned, file_path)
 		
 		if cleaned_count > 0:
 			self.logger.info(
 				"Cleaned %d type references to removed typedefs: %s", 
-				cleaned_count, list(removed_typedef_names)
+				cleaned_count, list(removed_types)
 			)
 		else:
 			self.logger.debug("No type references found to clean up")
+		return cleaned_files
+
+	def _type_references(self) -> TypeReferenceMap:
+		""""""
+		# Outside a container run there is nothing to reuse; index on demand
+		return self._type_map if self._type_map is not None else TypeReferenceMap()
 
 	def _update_type_references_for_renames(self, file_model: FileModel, typedef_renames: Dict[str, str]) -> None:
 		""""""
 		updated_count = 0
 		
-		for func in file_model.functions:
-			if func.return_type:
-				old_type = func.return_type
-				new_type = self._update_type_string_for_renames(func.return_type, typedef_renames)
-				if new_type != old_type:
-					func.return_type = new_type
-					updated_count += 1
-					self.logger.debug(
-						"Updated return type '%s' -> '%s' in function %s", 
-						old_type, new_type, func.name
-					)
-			
-			for param in func.parameters:
-				if param.type:
-					old_type = param.type
-					new_type = self._update_type_string_for_renames(param.type, typedef_renames)
-					if new_type != old_type:
-						param.type = new_type
-						updated_count += 1
-						self.logger.debug(
-							"Updated parameter type '%s' -> '%s' for parameter %s in function %s", 
-							old_type, new_type, param.name, func.name
-						)
-		
-		for global_var in file_model.globals:
-			if global_var.type:
-				old_type = global_var.type
-				new_type = self._update_type_string_for_renames(global_var.type, typedef_renames)
-				if new_type != old_type:
-					global_var.type = new_type
-					updated_count += 1
-					self.logger.debug(
-						"Updated global variable type '%s' -> '%s' for %s", 
-						old_type, new_type, global_var.name
-					)
-		
-		for struct in file_model.structs.values():
-			for field in struct.fields:
-				if field.type:
-					old_type = field.type
-					new_type = self._update_type_string_for_renames(field.type, typedef_renames)
-					if new_type != old_type:
-						field.type = new_type
-						updated_count += 1
-						self.logger.debug(
-							"Updated struct field type '%s' -> '%s' for %s.%s", 
-							old_type, new_type, struct.name, field.name
-						)
-		
-		for union in file_model.unions.values():
-			for field in union.fields:
-				if field.type:
-					old_type = field.type
-					new_type = self._update_type_string_for_renames(field.type, typedef_renames)
-					if new_type != old_type:
-						field.type = new_type
-						updated_count += 1
-						self.logger.debug(
-							"Updated union field type '%s' -> '%s' for %s.%s", 
-							old_type, new_type, union.name, field.name
-						)
+		type_map = self._type_references()
+		for slot in type_map.slots_with_words(file_model, typedef_renames):
+			old_type = slot.value
+			if not old_type:
+				continue
+			new_type = self._update_type_string_for_renames(old_type, typedef_renames)
+			if new_type != old_type:
+				type_map.set_type(slot, new_type)
+				updated_count += 1
+				self.logger.debug(
+					"Updated type '%s' -> '%s' for %s",
+					old_type, new_type, describe_slot(slot)
+				)
 		
 		if updated_count > 0:
 			self.logger.info(
@@ -984,11 +826,16 @@ class Transformer:
 				
 			seen_names.add(new_name)
 			
-			updated_element = element if new_name == name else create_renamed_element(new_name, element)
+			if new_name == name:
+				updated_element = element
+			else:
+				updated_element = create_renamed_element(new_name, element)
+				self._mark_changed(file_name)
 			deduplicated_elements[new_name] = updated_element
 		
 		removed_count = original_count - len(deduplicated_elements)
 		if removed_count > 0:
+			self._mark_changed(file_name)
 			self.logger.info(
 				"Renamed %ss in %s, removed %d duplicates", element_type, file_name, removed_count
 			)
@@ -1022,11 +869,16 @@ class Transformer:
 				
 			seen_names.add(new_name)
 			
-			updated_element = element if new_name == name else create_renamed_element(new_name, element)
+			if new_name == name:
+				updated_element = element
+			else:
+				updated_element = create_renamed_element(new_name, element)
+				self._mark_changed(file_name)
 			deduplicated_elements.append(updated_element)
 		
 		removed_count = original_count - len(deduplicated_elements)
 		if removed_count > 0:
+			self._mark_changed(file_name)
 			self.logger.info(
 				"Renamed %ss in %s, removed %d duplicates", element_type, file_name, removed_count
 			)
@@ -1035,22 +887,7 @@ class Transformer:
 
 	def _apply_rename_patterns(self, original_name: str, patterns_map: Dict[str, str]) -> str:
 		""""""
-		for pattern, replacement in patterns_map.items():
-			try:
-				new_name = re.sub(pattern, replacement, original_name)
-				if new_name != original_name:
-					self.logger.debug(
-						"Renamed '%s' to '%s' using pattern '%s'", 
-						original_name, new_name, pattern
-					)
-					return new_name
-			except re.error as e:
-				self.logger.warning(
-					"Invalid regex pattern '%s': %s", pattern, e
-				)
-				continue
-		
-		return original_name
+		return self.patterns.rename_rules(patterns_map).apply(original_name)
 
 	def _rename_typedefs(self, file_model: FileModel, patterns_map: Dict[str, str]) -> None:
 		""""""
@@ -1176,6 +1013,7 @@ class Transformer:
 		
 		removed_count = original_count - len(deduplicated_elements)
 		if removed_count > 0:
+			self._mark_changed(file_name)
 			self.logger.info(
 				"Renamed %ss in %s, removed %d duplicates", element_type, file_name, removed_count
 			)
@@ -1247,6 +1085,7 @@ class Transformer:
 				
 				if new_file_path != file_path:
 					file_model.name = new_file_path
+					self._mark_changed(new_file_path)
 					file_rename_map[Path(file_path).name] = Path(new_file_path).name
 					self.logger.debug("Renamed file: %s -> %s", file_path, new_file_path)
 				
@@ -1335,17 +1174,18 @@ class Transformer:
 			return elements_dict
 			
 		original_count = len(elements_dict)
-		compiled_patterns = self._compile_patterns(patterns)
+		matcher = self.patterns.matcher(patterns)
 		
 		filtered_elements = {}
 		for name, element in elements_dict.items():
-			if not self._matches_any_pattern(name, compiled_patterns):
+			if not matcher.matches(name):
 				filtered_elements[name] = element
 			else:
 				self.logger.debug("Removed %s: %s", element_type, name)
 		
 		removed_count = original_count - len(filtered_elements)
 		if removed_count > 0:
+			self._mark_changed(file_name)
 			self.logger.info(
 				"Removed %d %ss from %s", removed_count, element_type, file_name
 			)
@@ -1365,18 +1205,19 @@ class Transformer:
 			return elements_list
 			
 		original_count = len(elements_list)
-		compiled_patterns = self._compile_patterns(patterns)
+		matcher = self.patterns.matcher(patterns)
 		
 		filtered_elements = []
 		for element in elements_list:
 			name = get_element_name(element)
-			if not self._matches_any_pattern(name, compiled_patterns):
+			if not matcher.matches(name):
 				filtered_elements.append(element)
 			else:
 				self.logger.debug("Removed %s: %s", element_type, name)
 		
 		removed_count = original_count - len(filtered_elements)
 		if removed_count > 0:
+			self._mark_changed(file_name)
 			self.logger.info(
 				"Removed %d %ss from %s", removed_count, element_type, file_name
 			)
@@ -1427,11 +1268,11 @@ class Transformer:
 			return
 		
 		original_count = len(file_model.includes)
-		compiled_patterns = self._compile_patterns(patterns)
+		matcher = self.patterns.matcher(patterns)
 		
 		filtered_includes = set()
 		for include in file_model.includes:
-			if not self._matches_any_pattern(include, compiled_patterns):
+			if not matcher.matches(include):
 				filtered_includes.add(include)
 			else:
 				self.logger.debug("Removed include: %s", include)
@@ -1440,17 +1281,17 @@ class Transformer:
 		removed_count = original_count - len(file_model.includes)
 		
 		if removed_count > 0:
-			self._remove_matching_include_relations(file_model, compiled_patterns, removed_count)
+			self._remove_matching_include_relations(file_model, matcher, removed_count)
 
 	def _remove_matching_include_relations(
-		self, file_model: FileModel, compiled_patterns: List[Pattern[str]], removed_includes_count: int
+		self, file_model: FileModel, matcher: PatternMatcher, removed_includes_count: int
 	) -> None:
 		""""""
 		original_relations_count = len(file_model.include_relations)
 		filtered_relations = []
 		
 		for relation in file_model.include_relations:
-			if not self._matches_any_pattern(relation.included_file, compiled_patterns):
+			if not matcher.matches(relation.included_file):
 				filtered_relations.append(relation)
 			else:
 				self.logger.debug("Removed include relation: %s -> %s", 
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+Reverse type-reference map for the transformer.
+
+Indexes every type string of the model (function return and parameter types,
+globals, struct and union fields) by the identifier words it contains, so a
+removal or rename of K typedefs only visits the elements that mention them
+instead of sweeping every element of every file. Files are re-indexed lazily
+after a transformation step marks them as changed.
+"""
+
+import re
+from typing import Dict, FrozenSet, Iterable, List, Set
+
+from ..models import FileModel, ProjectModel
+
+_WORD_RE = re.compile(r"\w+")
+_IDENTIFIER_RE = re.compile(r"\w+\Z")
+_word_cache: Dict[str, FrozenSet[str]] = {}
+
+# Slot kinds covered when references to removed typedefs are cleaned up
+CLEANUP_KINDS = frozenset({"return", "parameter", "global", "struct_field"})
+
+
+def type_words(type_str: str) -> FrozenSet[str]:
+    """Return the maximal identifier-character runs of a type string (memoized)"""
+    words = _word_cache.get(type_str)
+    if words is None:
+        words = frozenset(_WORD_RE.findall(type_str)) if type_str else frozenset()
+        _word_cache[type_str] = words
+    return words
+
+
+class TypeSlot:
+    """One type string of the model and the element holding it"""
+
+    __slots__ = ("holder", "attribute", "kind", "owner", "file_key", "position", "words")
+
+    def __init__(self, holder, attribute: str, kind: str, owner: str, file_key: str, position: int):
+        self.holder = holder
+        self.attribute = attribute
+        self.kind = kind
+        # Name used in log messages (function, struct or union name)
+        self.owner = owner
+        self.file_key = file_key
+        self.position = position
+        self.words = type_words(self.value)
+
+    @property
+    def value(self) -> str:
+        return getattr(self.holder, self.attribute)
+
+
+class TypeReferenceMap:
+    """Maps identifier words to the type slots that contain them"""
+
+    def __init__(self):
+        self._file_slots: Dict[str, List[TypeSlot]] = {}
+        # Indexed FileModel per key; a different object means the file was replaced
+        self._file_models: Dict[str, FileModel] = {}
+        # word -> file key -> slots of that file containing the word
+        self._by_word: Dict[str, Dict[str, Set[TypeSlot]]] = {}
+        self._dirty: Set[str] = set()
+
+    def invalidate(self, file_keys: Iterable[str]) -> None:
+        """Mark files whose elements were replaced, added or removed"""
+        self._dirty.update(file_keys)
+
+    def set_type(self, slot: TypeSlot, value: str) -> None:
+        """Store a new type string in a slot and re-index its words"""
+        setattr(slot.holder, slot.attribute, value)
+        words = type_words(value)
+        for word in slot.words - words:
+            self._unlink(word, slot)
+        for word in words - slot.words:
+            self._by_word.setdefault(word, {}).setdefault(slot.file_key, set()).add(slot)
+        slot.words = words
+
+    def slots_with_words(self, file_model: FileModel, names: Iterable[str]) -> List[TypeSlot]:
+        """Return the slots of one file containing any of the names as a whole word"""
+        file_key = file_model.name
+        if file_key in self._dirty or self._file_models.get(file_key) is not file_model:
+            self._dirty.discard(file_key)
+            self._index_file(file_key, file_model)
+        names = list(names)
+        if not all(_IDENTIFIER_RE.match(name) for name in names):
+            return list(self._file_slots[file_key])
+        found: Set[TypeSlot] = set()
+        for name in names:
+            found.update(self._by_word.get(name, {}).get(file_key, ()))
+        return sorted(found, key=lambda slot: slot.position)
+
+    def slots_containing(self, model: ProjectModel, names: Iterable[str]) -> Dict[str, List[TypeSlot]]:
+        """Return, per file in model order, the slots whose type contains any name as a substring"""
+        self._sync(model)
+        names = list(names)
+        found: Dict[str, Set[TypeSlot]] = {}
+        if all(_IDENTIFIER_RE.match(name) for name in names):
+            # A substring made of word characters lies inside a single word
+            for word, slots_by_file in self._by_word.items():
+                if any(name in word for name in names):
+                    for key, slots in slots_by_file.items():
+                        found.setdefault(key, set()).update(slots)
+        else:
+            for key, slots in self._file_slots.items():
+                found[key] = set(slots)
+        return {
+            key: sorted(found[key], key=lambda slot: slot.position)
+            for key in model.files if key in found
+        }
+
+    def _sync(self, model: ProjectModel) -> None:
+        for key in [key for key in self._file_slots if key not in model.files]:
+            self._drop_file(key)
+        for key, file_model in model.files.items():
+            if key in self._dirty or self._file_models.get(key) is not file_model:
+                self._index_file(key, file_model)
+        self._dirty.clear()
+
+    def _index_file(self, key: str, file_model: FileModel) -> None:
+        self._drop_file(key)
+        slots: List[TypeSlot] = []
+
+        def add(holder, kind: str, owner: str, attribute: str = "type") -> None:
+            slot = TypeSlot(holder, attribute, kind, owner, key, len(slots))
+            slots.append(slot)
+            for word in slot.words:
+                self._by_word.setdefault(word, {}).setdefault(key, set()).add(slot)
+
+        for func in file_model.functions:
+            add(func, "return", func.name, "return_type")
+            for param in func.parameters:
+                add(param, "parameter", func.name)
+        for global_var in file_model.globals:
+            add(global_var, "global", global_var.name)
+        for struct in file_model.structs.values():
+            for struct_field in struct.fields:
+                add(struct_field, "struct_field", struct.name)
+        for union in file_model.unions.values():
+            for union_field in union.fields:
+                add(union_field, "union_field", union.name)
+        self._file_slots[key] = slots
+        self._file_models[key] = file_model
+
+    def _drop_file(self, key: str) -> None:
+        self._file_models.pop(key, None)
+        for slot in self._file_slots.pop(key, ()):
+            for word in slot.words:
+                self._unlink(word, slot)
+
+    def _unlink(self, word: str, slot: TypeSlot) -> None:
+        slots_by_file = self._by_word.get(word)
+        if slots_by_file is None:
+            return
+        slots = slots_by_file.get(slot.file_key)
+        if slots is not None:
+            slots.discard(slot)
+            if not slots:
+                del slots_by_file[slot.file_key]
+        if not slots_by_file:
+            del self._by_word[word]
+
+
+def describe_slot(slot: TypeSlot) -> str:
+    """Return a short label for log messages"""
+    holder_name = getattr(slot.holder, "name", "")
+    if slot.kind == "return":
+        return f"return type of function {slot.owner}"
+    if slot.kind == "parameter":
+        return f"parameter {holder_name} in function {slot.owner}"
+    if slot.kind == "global":
+        return f"global variable {slot.owner}"
+    return f"{slot.owner}.{holder_name}"
+
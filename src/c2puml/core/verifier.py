@@ -5,12 +5,28 @@ Verification module for C to PlantUML converter
 Performs sanity checks on the parsed model to ensure values make sense for C code.
 """
 
+import hashlib
 import logging
 import re
-from typing import List, Tuple
+from typing import Dict, List, Optional, Tuple
 
 from ..models import Alias, Enum, Field, FileModel, Function, ProjectModel, Struct, Union
 
+# "full" checks every file, "sample" a stable fraction of the files, "off" skips verification
+VERIFY_MODES = ("full", "sample", "off")
+
+
+def in_verification_sample(file_key: str, rate: float) -> bool:
+    """Return whether a file belongs to the verification sample of the given rate
+
+    The choice depends on the file key only, so every run (and every worker)
+    samples the same files.
+    """
+    if rate >= 1.0:
+        return True
+    bucket = int(hashlib.sha1(file_key.encode("utf-8")).hexdigest()[:8], 16)
+    return bucket < rate * 0x100000000
+
 
 class ModelVerifier:
     """Verifies the sanity of parsed C code model"""
@@ -19,12 +35,25 @@ class ModelVerifier:
         self.logger = logging.getLogger(__name__)
         self.issues = []
 
-    def verify_model(self, model: ProjectModel) -> Tuple[bool, List[str]]:
+    def verify_model(
+        self,
+        model: ProjectModel,
+        file_issues: Optional[Dict[str, List[str]]] = None,
+        sample_rate: float = 1.0,
+        max_issues: int = 0,
+    ) -> Tuple[bool, List[str]]:
         """
         Verify the sanity of the entire model
 
         Args:
             model: The ProjectModel to verify
+            file_issues: Per-file issues already found for these exact FileModels
+                (by parse workers or stored in the parse cache); those files are
+                not checked again
+            sample_rate: Fraction of the remaining files to check (see
+                in_verification_sample); 1.0 checks all of them
+            max_issues: Stop checking further files once this many issues were
+                found (0 = no limit)
 
         Returns:
             Tuple of (is_valid, list_of_issues)
@@ -38,8 +67,28 @@ class ModelVerifier:
         self._verify_filename_keys_and_relations(model)
 
         # Verify each file
+        checked = reused = skipped = 0
         for file_path, file_model in model.files.items():
-            self._verify_file(file_path, file_model)
+            if max_issues > 0 and len(self.issues) >= max_issues:
+                skipped += 1
+                continue
+            known = file_issues.get(file_path) if file_issues else None
+            if known is not None:
+                self.issues.extend(known)
+                reused += 1
+            elif in_verification_sample(file_path, sample_rate):
+                self._verify_file(file_path, file_model)
+                checked += 1
+            else:
+                skipped += 1
+
+        if reused or skipped:
+            self.logger.info(
+                "Model verification: %d files checked now, %d by the parse step or parse cache, %d skipped",
+                checked,
+                reused,
+                skipped,
+            )
 
         is_valid = not self.issues
 
@@ -52,6 +101,16 @@ class ModelVerifier:
 
         return is_valid, self.issues
 
+    def verify_file_model(self, file_path: str, file_model: FileModel) -> List[str]:
+        """Return the issues of a single file (the per-file part of verify_model)"""
+        saved_issues = self.issues
+        self.issues = []
+        try:
+            self._verify_file(file_path, file_model)
+            return self.issues
+        finally:
+            self.issues = saved_issues
+
     def _verify_project_data(self, model: ProjectModel) -> None:
         """Verify project-level data"""
         if not model.project_name or not model.project_name.strip():
@@ -0,0 +1,463 @@
+#!/usr/bin/env python3
+"""
+Resident watch session for the C to PlantUML converter.
+
+Keeps the parsed FileModels, the type-reference index and the transformer
+(with its compiled patterns) in memory between rebuilds. Each poll compares
+file modification signatures; only modified or added files are re-parsed,
+and only the diagrams whose include tree contains a file whose transformed
+model changed are rendered again.
+
+Files are parsed serially in discovery order, exactly as a run with jobs = 1.
+The preprocessor defines a file sees depend on the files parsed before it, so
+every file's defines and undefs are journaled: unchanged files replay their
+journal instead of being re-parsed, and when a re-parsed file's journal
+differs, every later file is re-parsed with the new define state.
+"""
+
+import glob
+import logging
+import os
+from pathlib import Path
+from typing import TYPE_CHECKING, Dict, List, Optional, Set, Tuple
+
+from ..models import FileModel, ProjectModel, TypeReferenceIndex
+from .discovery import SourceDiscovery
+from .generator import OUTPUT_PATTERNS, Generator
+from .parser import CParser, deduplicate_anonymous_structures
+from .preprocessor import HEADER_EXTENSIONS, PreprocessorManager, TranslationUnitPreprocessor
+from .symbol_index import ProjectSymbolIndex
+from .transformer import Transformer
+
+if TYPE_CHECKING:
+    from ..config import Config
+
+# (modification time in ns, size) of a source file
+FileSignature = Tuple[int, int]
+
+
+class _SourceFile:
+    """A discovered source file and its resident parse result"""
+
+    __slots__ = ("path", "relative_path", "folder_index", "signature", "journal", "file_model")
+
+    def __init__(self, path: str, relative_path: str, folder_index: int, signature: FileSignature):
+        self.path = path
+        self.relative_path = relative_path
+        self.folder_index = folder_index
+        self.signature = signature
+        # Defines and undefs recorded while the file was parsed
+        self.journal: List[Tuple[str, Optional[str]]] = []
+        self.file_model: Optional[FileModel] = None
+
+    @property
+    def order_key(self) -> Tuple[int, Path]:
+        """Position in the serial parse order"""
+        return self.folder_index, Path(self.path)
+
+
+def _declared_names(file_model: FileModel) -> Set[str]:
+    """Names a diagram showing file_model looks up in project-wide symbol sets
+
+    Typedef names are lower-cased because anonymous parents and children are
+    matched case-insensitively.
+    """
+    names = {func.name for func in file_model.functions}
+    names.update(global_var.name for global_var in file_model.globals)
+    for collection in (file_model.structs, file_model.enums, file_model.unions, file_model.aliases):
+        names.update(name.lower() for name in collection)
+    return names
+
+
+class _SymbolState:
+    """The project-wide lookups of ProjectSymbolIndex that diagrams depend on"""
+
+    def __init__(self, symbol_index: ProjectSymbolIndex):
+        self.header_functions = frozenset(symbol_index.header_function_decl_names)
+        self.header_globals = frozenset(symbol_index.header_global_names)
+        # File key -> its anonymous relationships in model order
+        self.anonymous: Dict[str, list] = {}
+        for key, parent_name, children in symbol_index.anonymous_relationships:
+            self.anonymous.setdefault(key, []).append((parent_name, tuple(children)))
+
+    def changed_names(self, previous: Optional["_SymbolState"]) -> Optional[Set[str]]:
+        """Return the names whose lookup result changed, or None for everything"""
+        if previous is None:
+            return None
+        names = set(self.header_functions.symmetric_difference(previous.header_functions))
+        names.update(self.header_globals.symmetric_difference(previous.header_globals))
+        # Composition lines follow the relationship order, so any difference in a
+        # file's list affects every name it mentions
+        for key in set(self.anonymous).union(previous.anonymous):
+            current = self.anonymous.get(key, [])
+            before = previous.anonymous.get(key, [])
+            if current != before:
+                for parent_name, children in current + before:
+                    names.add(parent_name.lower())
+                    names.update(child.lower() for child in children)
+        return names
+
+
+def file_signature(path: str) -> Optional[FileSignature]:
+    """Return the modification signature of a file, or None if it is gone"""
+    try:
+        stat = os.stat(path)
+    except OSError:
+        return None
+    return stat.st_mtime_ns, stat.st_size
+
+
+class WatchSession:
+    """Incrementally rebuilds model and diagrams for changed source files"""
+
+    def __init__(
+        self,
+        config: "Config",
+        transform_config_file: str,
+        output_dir: str,
+        model_file: Optional[str] = None,
+        transformed_model_file: Optional[str] = None,
+    ):
+        self.logger = logging.getLogger(__name__)
+        self.config = config
+        self.output_dir = output_dir
+        self.model_file = model_file
+        self.transformed_model_file = transformed_model_file
+        self.write_model_files = getattr(config, "write_model_files", True)
+
+        self.parser = CParser()
+        self.parser.tokenizer.engine = getattr(config, "tokenizer_engine", "line")
+        self.parser.reader.mmap_threshold = getattr(config, "mmap_threshold", 0)
+        self.parser.anonymous_extraction = getattr(config, "anonymous_extraction", "text")
+        self.parser.preprocessor_mode = getattr(config, "preprocessor_mode", "project")
+        self.deduplicate_anonymous = getattr(config, "deduplicate_anonymous", False)
+        self.transformer = Transformer()
+        self.transform_config = self.transformer._load_config(transform_config_file)
+        # Class level options are applied by main (configure_generator)
+        self.generator = Generator()
+
+        self._sources: Dict[str, _SourceFile] = {}
+        self._scanned: Optional[Dict[str, _SourceFile]] = None
+        # Signatures seen by the last rebuild attempt, successful or not
+        self._attempted: Dict[str, FileSignature] = {}
+        self._type_index: Optional[TypeReferenceIndex] = None
+        self._parsed_files: Dict[str, FileModel] = {}
+        # State of the last generated output
+        self._file_dicts: Dict[str, dict] = {}
+        self._symbols: Optional[_SymbolState] = None
+        # output file -> (root key, model keys of its include tree)
+        self._diagrams: Dict[str, Tuple[str, frozenset]] = {}
+        # output file -> last _write_diagram result (for the incremental manifest)
+        self._results: Dict[str, Tuple[str, Optional[str], bool]] = {}
+
+    @property
+    def source_count(self) -> int:
+        return len(self._sources)
+
+    def build(self) -> List[str]:
+        """Parse, transform and generate everything; returns the written diagrams"""
+        self._sources = {}
+        self._attempted = {}
+        self._type_index = None
+        self._file_dicts = {}
+        self._symbols = None
+        self._diagrams = {}
+        self._results = {}
+        if not self.generator.incremental_output:
+            self.generator._clear_output_folder(self.output_dir)
+        written = self._rebuild(self._scan(), set())
+        self.logger.info(
+            "Watch: initial build of %d files wrote %d diagrams", len(self._sources), len(written)
+        )
+        return written
+
+    def poll(self) -> Set[str]:
+        """Return the paths of files modified, added or removed since the last rebuild
+
+        A failed rebuild is only retried once the files change again.
+        """
+        scanned = self._scan()
+        if {path: source.signature for path, source in scanned.items()} == self._attempted:
+            return set()
+        self._scanned = scanned
+        changed = {
+            path for path, source in self._scanned.items()
+            if path not in self._sources or self._sources[path].signature != source.signature
+        }
+        changed.update(path for path in self._sources if path not in self._scanned)
+        return changed
+
+    def update(self, changed: Set[str]) -> List[str]:
+        """Rebuild after the given files changed; returns the written diagrams"""
+        if not changed:
+            return []
+        scanned = self._scanned if self._scanned is not None else self._scan()
+        self._scanned = None
+        written = self._rebuild(scanned, changed)
+        self.logger.info(
+            "Watch: %d changed files, rewrote %d diagrams", len(changed), len(written)
+        )
+        return written
+
+    def _scan(self) -> Dict[str, _SourceFile]:
+        """Discover the source files in serial parse order"""
+        scanned: Dict[str, _SourceFile] = {}
+        recursive_search = getattr(self.config, "recursive_search", True)
+        discovery = SourceDiscovery.from_config(self.config)
+        for folder_index, source_folder in enumerate(self.config.source_folders):
+            folder_path = Path(source_folder).resolve()
+            if not folder_path.is_dir():
+                raise ValueError(f"Source folder not found: {folder_path}")
+            for file_path in discovery.find(folder_path, recursive_search):
+                signature = file_signature(str(file_path))
+                if signature is None:
+                    continue
+                scanned[str(file_path)] = _SourceFile(
+                    str(file_path), str(file_path.relative_to(folder_path)), folder_index, signature
+                )
+        return scanned
+
+    def _parse_sources(self, scanned: Dict[str, _SourceFile], changed: Set[str]) -> Set[str]:
+        """Parse modified and added files, replaying the journals of the others
+
+        Returns the paths that were parsed. Nothing is committed when a file
+        fails to parse.
+        """
+        if self.parser.preprocessor_mode == "translation_unit":
+            return self._parse_translation_units(scanned, changed)
+        self.parser.preprocessor = PreprocessorManager()
+        evaluator = self.parser.preprocessor.evaluator
+
+        # Removed files that defined macros change the define state after them
+        removed_keys = sorted(
+            source.order_key for path, source in self._sources.items()
+            if path not in scanned and source.journal
+        )
+        state_changed = False
+        parsed: Set[str] = set()
+        failed = []
+        for path, source in scanned.items():
+            if removed_keys and removed_keys[0] < source.order_key:
+                state_changed = True
+            previous = self._sources.get(path)
+            if previous is not None and path not in changed and not state_changed:
+                source.journal = previous.journal
+                source.file_model = previous.file_model
+                evaluator.replay(previous.journal)
+                continue
+
+            evaluator.journal = []
+            try:
+                source.file_model = self.parser.parse_file(Path(path), source.relative_path)
+            except (OSError, ValueError) as e:
+                self.logger.warning("Failed to parse %s: %s", path, e)
+                failed.append(path)
+                continue
+            finally:
+                source.journal, evaluator.journal = evaluator.journal, None
+            if previous is None or source.journal != previous.journal:
+                state_changed = True
+            parsed.add(path)
+
+        if failed:
+            raise RuntimeError(f"Failed to parse {len(failed)} files: {failed}")
+        self._sources = scanned
+        return parsed
+
+    def _parse_translation_units(self, scanned: Dict[str, _SourceFile], changed: Set[str]) -> Set[str]:
+        """Parse modified and added files plus those whose included header defines changed
+
+        Header snapshots are recomputed only for changed headers and the headers
+        including them; any added or removed header recomputes them all, since
+        includes are also resolved by filename.
+        """
+        previous = self.parser.translation_units
+        header_paths = [path for path in scanned if path.endswith(HEADER_EXTENSIONS)]
+        units = TranslationUnitPreprocessor(header_paths, self.parser._load_tokens)
+        if previous is not None and previous.header_paths == units.header_paths:
+            units.snapshots = previous.reusable_snapshots(changed)
+            units.dependencies = dict(previous.dependencies)
+        units.compute_all()
+        if previous is not None:
+            changed_headers = {
+                path for path in set(units.header_paths).union(previous.header_paths)
+                if previous.snapshots.get(path) != units.snapshots.get(path)
+            }
+        else:
+            changed_headers = set(units.header_paths)
+
+        parsed: Set[str] = set()
+        failed = []
+        self.parser.translation_units = units
+        for path, source in scanned.items():
+            previous_source = self._sources.get(path)
+            if (
+                previous_source is not None
+                and path not in changed
+                and units.dependencies.get(path, frozenset()).isdisjoint(changed_headers)
+            ):
+                source.file_model = previous_source.file_model
+                continue
+            try:
+                source.file_model = self.parser.parse_file(Path(path), source.relative_path)
+            except (OSError, ValueError) as e:
+                self.logger.warning("Failed to parse %s: %s", path, e)
+                failed.append(path)
+                continue
+            parsed.add(path)
+
+        if failed:
+            # Keep the previous snapshots so the next attempt compares against them
+            self.parser.translation_units = previous
+            raise RuntimeError(f"Failed to parse {len(failed)} files: {failed}")
+        self._sources = scanned
+        return parsed
+
+    def _project_files(self) -> Dict[str, FileModel]:
+        """Combine the parsed files as Parser.parse_model does"""
+        all_files: Dict[str, FileModel] = {}
+        folder_files: Dict[str, FileModel] = {}
+        folder_index = 0
+        for source in self._sources.values():
+            if source.folder_index != folder_index:
+                all_files.update(folder_files)
+                folder_files = {}
+                folder_index = source.folder_index
+            name = source.file_model.name
+            if name in folder_files:
+                raise RuntimeError(
+                    f"Duplicate filename detected: '{name}' from '{source.path}'. "
+                    f"Already seen from '{folder_files[name].file_path}'."
+                )
+            folder_files[name] = source.file_model
+        all_files.update(folder_files)
+        return all_files
+
+    def _parsed_model(self) -> ProjectModel:
+        """Return the combined model with up to date uses fields"""
+        source_folders = self.config.source_folders
+        files = self._project_files()
+        if self.deduplicate_anonymous:
+            files = self._deduplicated(files)
+        model = ProjectModel(
+            project_name=getattr(self.config, "project_name", "C_Project"),
+            source_folder=",".join(source_folders) if len(source_folders) > 1 else source_folders[0],
+            files=files,
+        )
+        if self._type_index is None:
+            self._type_index = TypeReferenceIndex.build(model)
+            self._type_index.apply_uses(model)
+        else:
+            changed_keys = {
+                key for key, file_model in files.items()
+                if self._parsed_files.get(key) is not file_model
+            }
+            changed_keys.update(key for key in self._parsed_files if key not in files)
+            self._type_index.refresh(model, changed_keys)
+        self._parsed_files = files
+        return model
+
+    def _deduplicated(self, files: Dict[str, FileModel]) -> Dict[str, FileModel]:
+        """Deduplicate anonymous layouts, keeping last round's objects for unchanged results
+
+        Ownership is recomputed over all files, but a file whose deduplicated
+        model is equal to the previous one keeps the previous object, so the
+        type index only refreshes files that really changed.
+        """
+        deduplicated = deduplicate_anonymous_structures(files)
+        for key, file_model in deduplicated.items():
+            previous = self._parsed_files.get(key)
+            if previous is not None and previous is not file_model and previous == file_model:
+                deduplicated[key] = previous
+        return deduplicated
+
+    def _rebuild(self, scanned: Dict[str, _SourceFile], changed: Set[str]) -> List[str]:
+        self._attempted = {path: source.signature for path, source in scanned.items()}
+        self._parse_sources(scanned, changed)
+        model_data = self._parsed_model().to_dict()
+
+        transformed = self.transformer._apply_transformations(
+            ProjectModel.from_dict(model_data), self.transform_config
+        )
+        transformed_data = transformed.to_dict()
+        # Same normalized model the generate step would load from JSON
+        project_model = ProjectModel.from_dict(transformed_data)
+
+        written = self._generate(project_model, transformed_data["files"])
+
+        if self.write_model_files and self.model_file and self.transformed_model_file:
+            ProjectModel.save_dict(model_data, self.model_file)
+            ProjectModel.save_dict(transformed_data, self.transformed_model_file)
+        return written
+
+    def _generate(self, project_model: ProjectModel, file_dicts: Dict[str, dict]) -> List[str]:
+        """Render the diagrams affected by the changed transformed files"""
+        changed_keys = {
+            key for key, data in file_dicts.items() if self._file_dicts.get(key) != data
+        }
+        changed_keys.update(key for key in self._file_dicts if key not in file_dicts)
+
+        symbols = _SymbolState(ProjectSymbolIndex.for_model(project_model))
+        changed_names = symbols.changed_names(self._symbols)
+        file_names: Dict[str, Set[str]] = {}
+
+        def tree_uses_changed_names(tree_keys: frozenset) -> bool:
+            for key in tree_keys:
+                names = file_names.get(key)
+                if names is None:
+                    names = file_names[key] = _declared_names(project_model.files[key])
+                if not names.isdisjoint(changed_names):
+                    return True
+            return False
+
+        tasks = self.generator._collect_diagram_tasks(project_model, self.output_dir)
+        diagrams: Dict[str, Tuple[str, frozenset]] = {}
+        written = []
+        for output_file, root_key in tasks.items():
+            file_model = project_model.files[root_key]
+            include_tree = self.generator._build_include_tree(file_model, project_model)
+            # Files storing shared anonymous structures the diagram shows count as its tree
+            _shared, owner_keys = self.generator._collect_shared_anonymous(include_tree, project_model)
+            tree_keys = frozenset(include_tree).union(owner_keys)
+            diagrams[output_file] = (root_key, tree_keys)
+            previous = self._diagrams.get(output_file)
+            if (
+                changed_names is None
+                or previous != (root_key, tree_keys)
+                or not tree_keys.isdisjoint(changed_keys)
+                or (changed_names and tree_uses_changed_names(tree_keys))
+            ):
+                result = self.generator._write_diagram(file_model, project_model, output_file)
+                self._results[output_file] = result
+                if result[2]:
+                    written.append(output_file)
+            else:
+                path, content_hash, _ = self._results[output_file]
+                self._results[output_file] = (path, content_hash, False)
+
+        for output_file in [path for path in self._results if path not in diagrams]:
+            del self._results[output_file]
+        if self.generator.incremental_output:
+            self.generator._finish_incremental_output(self.output_dir, list(self._results.values()))
+        else:
+            self._remove_orphans(diagrams)
+
+        self._diagrams = diagrams
+        self._file_dicts = file_dicts
+        self._symbols = symbols
+        return written
+
+    def _remove_orphans(self, diagrams: Dict[str, Tuple[str, frozenset]]) -> None:
+        """Delete outputs of diagrams whose root file no longer exists"""
+        current_stems = {Path(path).stem for path in diagrams}
+        for output_file in self._diagrams:
+            stem = Path(output_file).stem
+            if stem in current_stems:
+                continue
+            for ext in OUTPUT_PATTERNS:
+                pattern = os.path.join(glob.escape(self.output_dir), glob.escape(stem) + ext[1:])
+                for file_path in glob.glob(pattern):
+                    try:
+                        os.remove(file_path)
+                    except OSError:
+                        pass  # Ignore errors if file can't be removed
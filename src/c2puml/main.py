@@ -6,6 +6,10 @@ Processing Flow:
 1. Parse C/C++ files and generate model.json
 2. Transform model based on configuration
 3. Generate PlantUML files from the transformed model
+4. Optionally render the diagrams to PNG images (render_images / render command)
+
+With --shard K/N the first three steps run for one shard of the project; the
+merge command combines the shard outputs (see core/sharding.py).
 """
 
 import argparse
@@ -13,12 +17,20 @@ import json
 import logging
 import os
 import sys
+import time
 from pathlib import Path
 
+from concurrent.futures import ThreadPoolExecutor
+
 from .config import Config
 from .core.generator import Generator
 from .core.parser import Parser
+from .core.profiler import DEFAULT_TOP_FILES, PROFILER
+from .core.renderer import DiagramRenderer
+from .core.sharding import ShardMerger, parse_shard_spec, shard_folder
 from .core.transformer import Transformer
+from .core.watch_session import WatchSession, file_signature
+from .models import ProjectModel
 
 
 def setup_logging(verbose: bool = False) -> None:
@@ -47,16 +59,200 @@ def load_config_from_path(config_path: str) -> dict:
         raise FileNotFoundError(f"Config path not found: {config_path}")
 
 
+def configure_generator(config: Config) -> None:
+    """Apply generator formatting and execution options from the config"""
+    Generator.max_function_signature_chars = getattr(config, "max_function_signature_chars", 0)
+    Generator.hide_macro_values = getattr(config, "hide_macro_values", False)
+    Generator.convert_empty_class_to_artifact = getattr(config, "convert_empty_class_to_artifact", False)
+    Generator.jobs = getattr(config, "generate_jobs", 1)
+    Generator.incremental_output = getattr(config, "incremental_output", False)
+    Generator.streaming_output = getattr(config, "streaming_output", False)
+
+
+def run_render(config: Config, output_folder: str) -> int:
+    """Render the diagrams of output_folder to PNG images; returns the exit code"""
+    summary = DiagramRenderer.from_config(config).render(output_folder)
+    return 1 if summary.failed else 0
+
+
+def run_shard(config: Config, config_file: str, shard: tuple, output_folder: str) -> str:
+    """Parse, transform and generate one shard into its shard folder; returns the folder"""
+    index, count = shard
+    folder = shard_folder(output_folder, index, count)
+    os.makedirs(folder, exist_ok=True)
+    _, model_file, transformed_model_file = resolve_output_paths(config)
+    model_file = os.path.join(folder, os.path.basename(model_file))
+    transformed_model_file = os.path.join(folder, os.path.basename(transformed_model_file))
+
+    parser_obj = Parser()
+    parser_obj.parse(
+        source_folders=config.source_folders,
+        output_file=model_file,
+        recursive_search=getattr(config, "recursive_search", True),
+        config=config,
+        shard=shard,
+    )
+    transformer = Transformer()
+    transformer.transform(
+        model_file=model_file, config_file=config_file, output_file=transformed_model_file
+    )
+
+    configure_generator(config)
+    generator = Generator()
+    generator.root_files = parser_obj.shard_plan.owned(index)
+    generator.generate(model_file=transformed_model_file, output_dir=folder)
+    parser_obj.shard_plan.write_manifest(
+        folder, index, os.path.basename(model_file), os.path.basename(transformed_model_file)
+    )
+    logging.info("Shard %d/%d complete! Output in: %s", index, count, folder)
+    return folder
+
+
+def run_in_memory_pipeline(
+    config: Config,
+    config_file: str,
+    model_file: str,
+    transformed_model_file: str,
+    output_folder: str,
+) -> None:
+    """Run parse, transform and generate passing models in memory.
+
+    Each stage receives the model of the previous stage itself, normalized in
+    place to the ordering it would have when loaded from JSON. When
+    config.write_model_files is set, one to_dict() snapshot per stage is
+    written by a background thread; the snapshot is a deep copy, so the next
+    stage can change the model while it is written.
+    """
+    write_model_files = getattr(config, "write_model_files", True)
+
+    with ThreadPoolExecutor(max_workers=1) as writer:
+        pending_writes = []
+
+        def hand_over(model: ProjectModel, output_file: str) -> ProjectModel:
+            model.normalize()
+            if write_model_files:
+                pending_writes.append(
+                    writer.submit(ProjectModel.save_dict, model.to_dict(), output_file)
+                )
+            return model
+
+        # Step 1: Parse
+        parser_obj = Parser()
+        model = parser_obj.parse_model(
+            source_folders=config.source_folders,
+            recursive_search=getattr(config, "recursive_search", True),
+            config=config,
+        )
+        model = hand_over(model, model_file)
+
+        # Step 2: Transform
+        transformer = Transformer()
+        model = transformer.transform_model(model, config_file)
+        model = hand_over(model, transformed_model_file)
+
+        # Step 3: Generate
+        configure_generator(config)
+        generator = Generator()
+        generator.generate_from_model(model, output_folder)
+
+        # Surface write errors before reporting success
+        for pending_write in pending_writes:
+            pending_write.result()
+
+    if write_model_files:
+        logging.info("Model saved to: %s", model_file)
+        logging.info("Transformed model saved to: %s", transformed_model_file)
+    logging.info("PlantUML generation complete! Output in: %s", output_folder)
+
+
+def resolve_output_paths(config: Config) -> tuple:
+    """Return (output folder, model file, transformed model file) for a config"""
+    # Determine output folder from config, default to ./output
+    output_folder = getattr(config, "output_dir", None) or os.path.join(
+        os.getcwd(), "output"
+    )
+    output_folder = os.path.abspath(output_folder)
+    os.makedirs(output_folder, exist_ok=True)
+
+    # The line-delimited format is selected by the model file extension
+    model_ext = ".jsonl" if getattr(config, "model_format", "json") == "jsonl" else ".json"
+    model_file = os.path.join(output_folder, "model" + model_ext)
+    transformed_model_file = os.path.join(output_folder, "model_transformed" + model_ext)
+    return output_folder, model_file, transformed_model_file
+
+
+def config_files(config_path: str) -> list:
+    """Return the JSON files a config path is loaded from"""
+    path = Path(config_path)
+    if path.is_dir():
+        return sorted(str(file) for file in path.glob("*.json"))
+    return [str(path)]
+
+
+def run_watch(config_path: str, poll_interval: float) -> int:
+    """Build once, then keep rebuilding changed diagrams until interrupted
+
+    The parsed model stays in memory; a change of the configuration itself
+    starts a new session with a full build.
+    """
+    session = None
+    watched_config = None
+    try:
+        while True:
+            config_state = {path: file_signature(path) for path in config_files(config_path)}
+            try:
+                if config_state != watched_config:
+                    watched_config = config_state
+                    config = Config(**load_config_from_path(config_path))
+                    output_folder, model_file, transformed_model_file = resolve_output_paths(config)
+                    configure_generator(config)
+                    session = WatchSession(
+                        config,
+                        (
+                            config_path
+                            if Path(config_path).is_file()
+                            else str(list(Path(config_path).glob("*.json"))[0])
+                        ),
+                        output_folder,
+                        model_file,
+                        transformed_model_file,
+                    )
+                    session.build()
+                    if getattr(config, "render_images", False):
+                        run_render(config, output_folder)
+                    logging.info(
+                        "Watching %d files for changes (Ctrl+C to stop)", session.source_count
+                    )
+                elif session is not None:
+                    changed = session.poll()
+                    if changed:
+                        started = time.perf_counter()
+                        session.update(changed)
+                        if getattr(config, "render_images", False):
+                            run_render(config, output_folder)
+                        logging.info("Rebuilt in %.3fs", time.perf_counter() - started)
+            except (OSError, ValueError, RuntimeError) as e:
+                # Keep watching; the next save may fix the problem
+                logging.error("Watch rebuild failed: %s", e)
+            time.sleep(poll_interval)
+    except KeyboardInterrupt:
+        logging.info("Watch stopped")
+        return 0
+
+
 def main() -> int:
     parser = argparse.ArgumentParser(
         description="C to PlantUML Converter (Simplified CLI)",
         formatter_class=argparse.RawDescriptionHelpFormatter,
         epilog="""
 Usage:
-  %(prog)s --config config.json [parse|transform|generate]
-  %(prog)s config_folder [parse|transform|generate]
-  %(prog)s [parse|transform|generate]  # Uses current directory as config folder
-  %(prog)s              # Full workflow (parse, transform, generate)
+  %(prog)s --config config.json [parse|transform|generate|render|watch]
+  %(prog)s config_folder [parse|transform|generate|render|watch]
+  %(prog)s [parse|transform|generate|render|watch]  # Uses current directory as config folder
+  %(prog)s              # Full workflow (parse, transform, generate; render if render_images)
+  %(prog)s --config config.json watch  # Rebuild changed diagrams on every save
+  %(prog)s --config config.json --shard 2/8  # Parse, transform and generate shard 2 of 8
+  %(prog)s --config config.json merge  # Combine the shard outputs
         """,
     )
     parser.add_argument(
@@ -69,16 +265,75 @@ Usage:
     parser.add_argument(
         "command",
         nargs="?",
-        choices=["parse", "transform", "generate"],
-        help="Which step to run: parse, transform, or generate. If omitted, runs full workflow.",
+        choices=["parse", "transform", "generate", "render", "watch", "merge"],
+        help="Which step to run: parse, transform, generate, render (PNG images of the "
+        "generated diagrams), watch (keep running and rebuild on changes), or merge "
+        "(combine the outputs of --shard runs). If omitted, runs full workflow.",
     )
     parser.add_argument(
         "--verbose", "-v", action="store_true", help="Enable verbose output"
     )
+    parser.add_argument(
+        "--jobs",
+        "-j",
+        type=int,
+        default=None,
+        help="Number of parser worker processes (0 = one per CPU, default: config 'jobs' or 1)",
+    )
+    parser.add_argument(
+        "--shard",
+        type=str,
+        default=None,
+        metavar="K/N",
+        help="Run parse, transform and generate for shard K of N into <output_dir>/shards",
+    )
+    parser.add_argument(
+        "--poll-interval",
+        type=float,
+        default=0.5,
+        metavar="SECONDS",
+        help="How often the watch command checks files for changes (default: 0.5)",
+    )
+    parser.add_argument(
+        "--profile-report",
+        type=str,
+        default=None,
+        metavar="FILE",
+        help="Write per-stage timing and memory statistics as JSON to FILE",
+    )
+    parser.add_argument(
+        "--profile-top",
+        type=int,
+        default=DEFAULT_TOP_FILES,
+        metavar="N",
+        help=f"Number of slowest files listed in the profile report (default: {DEFAULT_TOP_FILES})",
+    )
+    parser.add_argument(
+        "--profile-no-memory",
+        action="store_true",
+        help="Profile wall time only; skip tracemalloc, which slows the run down",
+    )
     args = parser.parse_args()
 
     setup_logging(args.verbose)
 
+    if not args.profile_report:
+        return run_command(args)
+
+    PROFILER.start(trace_memory=not args.profile_no_memory)
+    try:
+        return run_command(args)
+    finally:
+        try:
+            PROFILER.write_report(args.profile_report, args.profile_top)
+            logging.info("Profile report saved to: %s", args.profile_report)
+        except OSError as e:
+            logging.error("Failed to write profile report %s: %s", args.profile_report, e)
+        PROFILER.stop()
+
+
+def run_command(args: argparse.Namespace) -> int:
+    """Run the selected step (or the full workflow) for parsed command line arguments"""
     # Determine config path
     config_path = args.config
     if config_path is None:
@@ -94,16 +349,50 @@ Usage:
         logging.error("Failed to load configuration: %s", e)
         return 1
 
-    # Determine output folder from config, default to ./output
-    output_folder = getattr(config, "output_dir", None) or os.path.join(
-        os.getcwd(), "output"
-    )
-    output_folder = os.path.abspath(output_folder)
-    os.makedirs(output_folder, exist_ok=True)
+    # Command line overrides the configured parser job count
+    if args.jobs is not None:
+        config.jobs = args.jobs
+
+    output_folder, model_file, transformed_model_file = resolve_output_paths(config)
     logging.info("Output folder: %s", output_folder)
 
-    model_file = os.path.join(output_folder, "model.json")
-    transformed_model_file = os.path.join(output_folder, "model_transformed.json")
+    if args.command == "watch":
+        return run_watch(config_path, args.poll_interval)
+
+    # Sharded run: the first three steps for one shard
+    if args.shard is not None:
+        if args.command is not None:
+            logging.error("--shard runs the full workflow of one shard; omit the '%s' command", args.command)
+            return 1
+        try:
+            shard = parse_shard_spec(args.shard)
+            run_shard(
+                config,
+                config_file=(
+                    config_path
+                    if Path(config_path).is_file()
+                    else str(list(Path(config_path).glob("*.json"))[0])
+                ),
+                shard=shard,
+                output_folder=output_folder,
+            )
+            return 0
+        except (OSError, ValueError, RuntimeError) as e:
+            logging.error("Error in shard run: %s", e)
+            return 1
+
+    # Merge command
+    if args.command == "merge":
+        try:
+            ShardMerger(output_folder).merge(model_file, transformed_model_file)
+            logging.info("Model saved to: %s", model_file)
+            logging.info("Transformed model saved to: %s", transformed_model_file)
+            if getattr(config, "render_images", False):
+                return run_render(config, output_folder)
+            return 0
+        except (OSError, ValueError, RuntimeError) as e:
+            logging.error("Error merging shard outputs: %s", e)
+            return 1
 
     # Parse command
     if args.command == "parse":
@@ -152,11 +441,8 @@ Usage:
     # Generate command
     if args.command == "generate":
         try:
+            configure_generator(config)
             generator = Generator()
-            # Apply config for signature truncation and macro display
-            Generator.max_function_signature_chars = getattr(config, "max_function_signature_chars", 0)
-            Generator.hide_macro_values = getattr(config, "hide_macro_values", False)
-            Generator.convert_empty_class_to_artifact = getattr(config, "convert_empty_class_to_artifact", False)
             # Prefer transformed model, else fallback to model.json
             if os.path.exists(transformed_model_file):
                 model_to_use = transformed_model_file
@@ -176,8 +462,33 @@ Usage:
             logging.error("Error generating PlantUML: %s", e)
             return 1
 
+    # Render command
+    if args.command == "render":
+        try:
+            return run_render(config, output_folder)
+        except (OSError, ValueError, RuntimeError) as e:
+            logging.error("Error rendering diagrams: %s", e)
+            return 1
+
     # Default: full workflow
     try:
+        if getattr(config, "in_memory_pipeline", False):
+            run_in_memory_pipeline(
+                config,
+                config_file=(
+                    config_path
+                    if Path(config_path).is_file()
+                    else str(list(Path(config_path).glob("*.json"))[0])
+                ),
+                model_file=model_file,
+                transformed_model_file=transformed_model_file,
+                output_folder=output_folder,
+            )
+            if getattr(config, "render_images", False) and run_render(config, output_folder):
+                return 1
+            logging.info("Complete workflow finished successfully!")
+            return 0
+
         # Step 1: Parse
         parser_obj = Parser()
         # Use the parse function with multiple source folders
@@ -201,16 +512,16 @@ Usage:
         )
         logging.info("Transformed model saved to: %s", transformed_model_file)
         # Step 3: Generate
+        configure_generator(config)
         generator = Generator()
-        # Apply config for signature truncation and macro display
-        Generator.max_function_signature_chars = getattr(config, "max_function_signature_chars", 0)
-        Generator.hide_macro_values = getattr(config, "hide_macro_values", False)
-        Generator.convert_empty_class_to_artifact = getattr(config, "convert_empty_class_to_artifact", False)
         generator.generate(
             model_file=transformed_model_file,
             output_dir=output_folder,
         )
         logging.info("PlantUML generation complete! Output in: %s", output_folder)
+        # Step 4: Render
+        if getattr(config, "render_images", False) and run_render(config, output_folder):
+            return 1
         logging.info("Complete workflow finished successfully!")
         return 0
     except (OSError, ValueError, RuntimeError) as e:
@@ -4,8 +4,17 @@ Data models for C to PlantUML converter
 """
 
 import json
+import os
+import re
+from collections.abc import MutableMapping
 from dataclasses import asdict, dataclass, field
-from typing import Dict, List, Optional, Set
+from typing import Dict, FrozenSet, Iterable, Iterator, List, Optional, Set, Tuple
+
+# Line-delimited model format: a header record followed by one record per file
+JSONL_FORMAT = "c2puml-jsonl"
+JSONL_FORMAT_VERSION = 1
+JSONL_EXTENSION = ".jsonl"
+JSONL_KEY_PREFIX = '{"key":'
 
 
 @dataclass
@@ -240,6 +249,22 @@ class FileModel:
         # Tag names are now stored in struct/enum/union objects
         return data
 
+    def normalize(self) -> None:
+        """Apply the ordering of to_dict in place, as if loaded from JSON"""
+        self.include_relations.sort(key=lambda x: (x.source_file, x.included_file))
+        self.structs = dict(sorted(self.structs.items()))
+        self.enums = dict(sorted(self.enums.items()))
+        self.unions = dict(sorted(self.unions.items()))
+        self.aliases = dict(sorted(self.aliases.items()))
+        self.macros.sort()
+        self.anonymous_relationships = {
+            k: sorted(v) for k, v in sorted(self.anonymous_relationships.items())
+        }
+        self.functions.sort(key=lambda x: x.name)
+        self.globals.sort(key=lambda x: x.name)
+        for typed in (*self.structs.values(), *self.unions.values(), *self.aliases.values()):
+            typed.uses.sort()
+
     @classmethod
     def from_dict(cls, data: dict) -> "FileModel":
         """Create from dictionary"""
@@ -288,7 +313,11 @@ class FileModel:
                     EnumValue(**val) if isinstance(val, dict) else EnumValue(val)
                     for val in enum_data.get("values", [])
                 ]
-                enums[name] = Enum(name=enum_data.get("name", name), values=values)
+                enums[name] = Enum(
+                    name=enum_data.get("name", name),
+                    values=values,
+                    tag_name=enum_data.get("tag_name", ""),
+                )
             else:
                 enums[name] = enum_data
 
@@ -367,8 +396,23 @@ class ProjectModel:
             raise ValueError("Source folder must be a non-empty string")
 
     def save(self, file_path: str) -> None:
-        """Save model to JSON file"""
-        data = {
+        """Save model to JSON file (or line-delimited JSONL for a .jsonl path)"""
+        if str(file_path).endswith(JSONL_EXTENSION):
+            # Serialize one file at a time instead of building the whole tree
+            try:
+                with ModelStreamWriter(
+                    file_path, self.project_name, self.source_folder
+                ) as writer:
+                    for path, file_model in sorted(self.files.items()):
+                        writer.write_file(path, file_model)
+            except Exception as e:
+                raise ValueError(f"Failed to save model to {file_path}: {e}") from e
+            return
+        self.save_dict(self.to_dict(), file_path)
+
+    def to_dict(self) -> dict:
+        """Convert to dictionary for JSON serialization"""
+        return {
             "project_name": self.project_name,
             "source_folder": self.source_folder,
             "files": {
@@ -377,7 +421,23 @@ class ProjectModel:
             },
         }
 
+    def normalize(self) -> None:
+        """Apply the ordering of to_dict in place, as if loaded from JSON"""
+        self.files = dict(sorted(self.files.items()))
+        for file_model in self.files.values():
+            file_model.normalize()
+
+    @staticmethod
+    def save_dict(data: dict, file_path: str) -> None:
+        """Write a model dictionary (as returned by to_dict) to a JSON or JSONL file"""
         try:
+            if str(file_path).endswith(JSONL_EXTENSION):
+                with ModelStreamWriter(
+                    file_path, data["project_name"], data["source_folder"]
+                ) as writer:
+                    for path, file_data in data["files"].items():
+                        writer.write_file_dict(path, file_data)
+                return
             with open(file_path, "w", encoding="utf-8") as f:
                 json.dump(data, f, indent=2, ensure_ascii=False, sort_keys=True)
         except Exception as e:
@@ -399,112 +459,339 @@ class ProjectModel:
 
     @classmethod
     def load(cls, file_path: str) -> "ProjectModel":
-        """Load model from JSON file"""
+        """Load model from JSON file (a .jsonl file is loaded lazily)"""
         try:
+            if str(file_path).endswith(JSONL_EXTENSION):
+                return cls.load_jsonl(file_path)
             with open(file_path, "r", encoding="utf-8") as f:
                 data = json.load(f)
             return cls.from_dict(data)
         except Exception as e:
             raise ValueError(f"Failed to load model from {file_path}: {e}") from e
 
+    @classmethod
+    def load_jsonl(cls, file_path: str) -> "ProjectModel":
+        """Load a JSONL model, materializing each FileModel on first access"""
+        files = LazyFileModels(file_path)
+        return cls(
+            project_name=files.header.get("project_name", "Unknown"),
+            source_folder=files.header.get("source_folder", ""),
+            files=files,
+        )
+
 
 
     def update_uses_fields(self):
         """Update all uses fields across the entire project model"""
-        # Collect all available type names from the entire project
-        available_types = set()
-        for file_model in self.files.values():
-            available_types.update(file_model.structs.keys())
-            available_types.update(file_model.enums.keys())
-            available_types.update(file_model.unions.keys())
-            available_types.update(file_model.aliases.keys())
+        TypeReferenceIndex.build(self).apply_uses(self)
 
-        # Update uses fields for all structures in all files
-        for file_model in self.files.values():
-            # Update struct uses
-            for struct in file_model.structs.values():
-                filtered_uses = []
-                for struct_field in struct.fields:
-                    field_uses = self._extract_non_primitive_types(
-                        struct_field.type, available_types
-                    )
-                    filtered_uses.extend(field_uses)
-                struct.uses = list(set(filtered_uses))
-
-            # Update union uses
-            for union in file_model.unions.values():
-                filtered_uses = []
-                for union_field in union.fields:
-                    field_uses = self._extract_non_primitive_types(
-                        union_field.type, available_types
-                    )
-                    filtered_uses.extend(field_uses)
-                union.uses = list(set(filtered_uses))
 
-            # Update alias uses
-            for alias in file_model.aliases.values():
-                alias.uses = self._extract_non_primitive_types(
-                    alias.original_type, available_types
-                )
-                # Remove the alias name from its own uses list
-                if alias.name in alias.uses:
-                    alias.uses.remove(alias.name)
-
-    def _extract_non_primitive_types(self, type_str: str, available_types: set) -> list:
-        """Extract non-primitive type names from a type string that exist in available_types"""
-        # Define primitive types
-        primitive_types = {
-            "void",
-            "char",
-            "short",
-            "int",
-            "long",
-            "float",
-            "double",
-            "signed",
-            "unsigned",
-            "const",
-            "volatile",
-            "static",
-            "extern",
-            "auto",
-            "register",
-            "inline",
-            "restrict",
-            "size_t",
-            "ptrdiff_t",
-            "int8_t",
-            "int16_t",
-            "int32_t",
-            "int64_t",
-            "uint8_t",
-            "uint16_t",
-            "uint32_t",
-            "uint64_t",
-            "intptr_t",
-            "uintptr_t",
-            "bool",
-            "true",
-            "false",
-            "NULL",
-            "nullptr",
-        }
+# Names never reported in "uses": C keywords plus builtin and stdint types
+PRIMITIVE_TYPES = frozenset({
+    "void", "char", "short", "int", "long", "float", "double", "signed",
+    "unsigned", "const", "volatile", "static", "extern", "auto", "register",
+    "inline", "restrict", "size_t", "ptrdiff_t", "int8_t", "int16_t",
+    "int32_t", "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t",
+    "intptr_t", "uintptr_t", "bool", "true", "false", "NULL", "nullptr",
+})
+
+_TYPE_SPLIT_RE = re.compile(r"[\[\]\(\)\{\}\s\*&,;]")
+_TYPE_NAME_RE = re.compile(r"^[a-zA-Z_][a-zA-Z0-9_]*$")
+_type_name_cache: Dict[str, FrozenSet[str]] = {}
+
+# Collections whose elements carry a "uses" list, and all typedef-like collections
+USES_COLLECTIONS = ("structs", "unions", "aliases")
+DEFINITION_COLLECTIONS = ("structs", "enums", "unions", "aliases")
+
+# (file key, collection name, element name)
+TypeOwner = Tuple[str, str, str]
+
+
+def referenced_type_names(type_str: str) -> FrozenSet[str]:
+    """Return the identifiers of a type string that may name a project type
+
+    Results are memoized per type string; the same field types recur across
+    thousands of structs.
+    """
+    names = _type_name_cache.get(type_str)
+    if names is None:
+        names = frozenset(
+            part for part in _TYPE_SPLIT_RE.split(type_str)
+            if len(part) > 1 and part not in PRIMITIVE_TYPES and _TYPE_NAME_RE.match(part)
+        )
+        _type_name_cache[type_str] = names
+    return names
+
+
+class TypeReferenceIndex:
+    """Type names referenced by each struct, union and alias of a project
+
+    Every element's referenced identifiers are recorded once and resolved
+    against a table of the project's type definitions. After elements are
+    renamed or removed, refresh() re-indexes just the changed files and
+    updates the uses of the elements whose references were affected.
+    """
+
+    def __init__(self):
+        # Type name -> number of files defining it
+        self._definitions: Dict[str, int] = {}
+        self._file_definitions: Dict[str, Set[str]] = {}
+        self._file_owners: Dict[str, List[TypeOwner]] = {}
+        self._references: Dict[TypeOwner, FrozenSet[str]] = {}
+        # Type name -> elements referencing it
+        self._referrers: Dict[str, Set[TypeOwner]] = {}
+        # Files changed since the last refresh
+        self._pending: Set[str] = set()
 
-        # Remove common C keywords and operators
-        import re
+    @classmethod
+    def build(cls, model: "ProjectModel") -> "TypeReferenceIndex":
+        """Index every file of a model"""
+        index = cls()
+        for key, file_model in model.files.items():
+            index._add_file(key, file_model)
+        return index
+
+    @staticmethod
+    def _defined_names(file_model: FileModel) -> Set[str]:
+        defined = set()
+        for collection_name in DEFINITION_COLLECTIONS:
+            defined.update(getattr(file_model, collection_name))
+        return defined
+
+    def _add_file(self, key: str, file_model: FileModel) -> None:
+        defined = self._defined_names(file_model)
+        for name in defined:
+            self._definitions[name] = self._definitions.get(name, 0) + 1
+        self._file_definitions[key] = defined
+
+        owners = []
+        for collection_name in USES_COLLECTIONS:
+            for name, element in getattr(file_model, collection_name).items():
+                owner = (key, collection_name, name)
+                if collection_name == "aliases":
+                    references = referenced_type_names(element.original_type)
+                else:
+                    references = frozenset().union(
+                        *(referenced_type_names(f.type) for f in element.fields)
+                    )
+                self._references[owner] = references
+                for type_name in references:
+                    self._referrers.setdefault(type_name, set()).add(owner)
+                owners.append(owner)
+        self._file_owners[key] = owners
+
+    def _remove_file(self, key: str) -> None:
+        for name in self._file_definitions.pop(key, ()):
+            count = self._definitions[name] - 1
+            if count:
+                self._definitions[name] = count
+            else:
+                del self._definitions[name]
+        for owner in self._file_owners.pop(key, ()):
+            for type_name in self._references.pop(owner):
+                referrers = self._referrers[type_name]
+                referrers.discard(owner)
+                if not referrers:
+                    del self._referrers[type_name]
+
+    def uses_of(self, owner: TypeOwner) -> List[str]:
+        """Return the sorted project types an indexed element references"""
+        uses = [name for name in self._references[owner] if name in self._definitions]
+        if owner[1] == "aliases" and owner[2] in uses:
+            # An alias does not use itself
+            uses.remove(owner[2])
+        return sorted(uses)
+
+    def apply_uses(self, model: "ProjectModel", owners: Optional[Iterable[TypeOwner]] = None) -> int:
+        """Write uses of the given elements (default: all) back to the model"""
+        if owners is None:
+            owners = list(self._references)
+        updated = 0
+        for owner in owners:
+            key, collection_name, name = owner
+            element = getattr(model.files[key], collection_name)[name]
+            uses = self.uses_of(owner)
+            if element.uses != uses:
+                element.uses = uses
+                updated += 1
+        return updated
+
+    def invalidate(self, file_keys: Iterable[str]) -> None:
+        """Mark files as changed without refreshing yet"""
+        self._pending.update(file_keys)
+
+    def refresh(self, model: "ProjectModel", file_keys: Iterable[str] = ()) -> int:
+        """Re-index changed files and update the uses they affect
+
+        Files marked by invalidate() and files added to or dropped from the
+        model since the last refresh are picked up as well. Returns the number
+        of elements whose uses changed.
+        """
+        current_keys = model.files.keys()
+        file_keys = self._pending.union(file_keys)
+        self._pending.clear()
+        changed_keys = {key for key in file_keys if key in current_keys or key in self._file_owners}
+        changed_keys.update(key for key in self._file_owners if key not in current_keys)
+        changed_keys.update(key for key in current_keys if key not in self._file_owners)
+
+        candidates = {
+            name for key in changed_keys for name in self._file_definitions.get(key, ())
+        }
+        for key in changed_keys:
+            if key in current_keys:
+                candidates.update(self._defined_names(model.files[key]))
+        defined_before = {name for name in candidates if name in self._definitions}
+
+        for key in changed_keys:
+            self._remove_file(key)
+        for key in changed_keys:
+            if key in current_keys:
+                self._add_file(key, model.files[key])
+
+        # A name whose definition appeared or disappeared changes the uses of
+        # every element referencing it; re-indexed files are resolved anyway
+        affected = {
+            owner for key in changed_keys for owner in self._file_owners.get(key, ())
+        }
+        defined_after = {name for name in candidates if name in self._definitions}
+        for name in defined_before.symmetric_difference(defined_after):
+            affected.update(self._referrers.get(name, ()))
+        return self.apply_uses(model, affected)
+
+
+class ModelStreamWriter:
+    """Writes a project model as line-delimited JSON, one file record at a time
+
+    The first line is a header record with the project metadata, every further
+    line is ``{"key": <file key>, "file": <FileModel.to_dict()>}``. The writer
+    is fed from a complete ProjectModel (save / save_dict): only serialization
+    is streamed, the model itself is still built in memory.
+
+    Records go to a temporary file next to file_path, which replaces file_path
+    only when the writer is closed without an error. A model loaded lazily from
+    file_path can therefore be saved back to the same path.
+    """
+
+    def __init__(self, file_path: str, project_name: str, source_folder: str):
+        self.file_path = file_path
+        self._temp_path = f"{file_path}.tmp"
+        self._file = open(self._temp_path, "w", encoding="utf-8")
+        header = {
+            "format": JSONL_FORMAT,
+            "version": JSONL_FORMAT_VERSION,
+            "project_name": project_name,
+            "source_folder": source_folder,
+        }
+        self._file.write(self._dumps(header) + "\n")
+
+    @staticmethod
+    def _dumps(data: dict) -> str:
+        return json.dumps(data, ensure_ascii=False, sort_keys=True, separators=(",", ":"))
+
+    def write_file(self, key: str, file_model: FileModel) -> None:
+        """Append one FileModel record"""
+        self.write_file_dict(key, file_model.to_dict())
+
+    def write_file_dict(self, key: str, file_data: dict) -> None:
+        """Append one file record from an already serialized FileModel"""
+        # The key comes first so readers can index records without decoding them
+        self._file.write(
+            f"{JSONL_KEY_PREFIX}{json.dumps(key, ensure_ascii=False)},"
+            f'"file":{self._dumps(file_data)}}}\n'
+        )
 
-        # Split by common delimiters and operators
-        parts = re.split(r"[\[\]\(\)\{\}\s\*&,;]", type_str)
+    def close(self) -> None:
+        """Finish the file and move it over file_path"""
+        self._file.close()
+        os.replace(self._temp_path, self.file_path)
 
-        # Extract potential type names that exist in available_types
-        types = []
-        for part in parts:
-            part = part.strip()
-            if part and len(part) > 1 and part not in primitive_types:
-                # Check if it looks like a type name (starts with letter, contains letters/numbers/underscores)
-                if re.match(r"^[a-zA-Z_][a-zA-Z0-9_]*$", part):
-                    # Only include if it exists in available_types
-                    if part in available_types:
-                        types.append(part)
+    def discard(self) -> None:
+        """Drop the records written so far, leaving file_path untouched"""
+        self._file.close()
+        try:
+            os.remove(self._temp_path)
+        except OSError:
+            pass
+
+    def __enter__(self) -> "ModelStreamWriter":
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> None:
+        if exc_type is None:
+            self.close()
+        else:
+            self.discard()
+
+
+class LazyFileModels(MutableMapping):
+    """Mapping of file key to FileModel backed by a JSONL model file
+
+    Opening only indexes the byte offset of every record; a FileModel is parsed
+    when it is first accessed and then kept. Assigned and deleted entries
+    behave like a normal dict.
+    """
+
+    def __init__(self, file_path: str):
+        self.file_path = file_path
+        self._offsets: Dict[str, int] = {}
+        self._loaded: Dict[str, FileModel] = {}
+        self._order: Dict[str, None] = {}
+        decoder = json.JSONDecoder()
+
+        with open(file_path, "rb") as f:
+            header_line = f.readline()
+            self.header = json.loads(header_line.decode("utf-8"))
+            if self.header.get("format") != JSONL_FORMAT:
+                raise ValueError(f"Not a {JSONL_FORMAT} model file: {file_path}")
+            offset = len(header_line)
+            for line in f:
+                if line.strip():
+                    text = line[:4096].decode("utf-8", errors="ignore")
+                    try:
+                        key, _ = decoder.raw_decode(text, len(JSONL_KEY_PREFIX))
+                    except ValueError:
+                        key, _ = decoder.raw_decode(line.decode("utf-8"), len(JSONL_KEY_PREFIX))
+                    self._offsets[key] = offset
+                    self._order[key] = None
+                offset += len(line)
+
+    def _materialize(self, key: str) -> FileModel:
+        with open(self.file_path, "rb") as f:
+            f.seek(self._offsets[key])
+            record = json.loads(f.readline().decode("utf-8"))
+        file_model = FileModel.from_dict(record["file"])
+        self._loaded[key] = file_model
+        return file_model
+
+    def __getitem__(self, key: str) -> FileModel:
+        if key in self._loaded:
+            return self._loaded[key]
+        if key not in self._offsets:
+            raise KeyError(key)
+        return self._materialize(key)
+
+    def __setitem__(self, key: str, value: FileModel) -> None:
+        self._loaded[key] = value
+        self._order[key] = None
+
+    def __delitem__(self, key: str) -> None:
+        if key not in self._order:
+            raise KeyError(key)
+        del self._order[key]
+        self._loaded.pop(key, None)
+        self._offsets.pop(key, None)
+
+    def __iter__(self) -> Iterator[str]:
+        return iter(list(self._order))
+
+    def __len__(self) -> int:
+        return len(self._order)
+
+    def __contains__(self, key: object) -> bool:
+        return key in self._order
+
+    @property
+    def loaded_count(self) -> int:
+        """Number of FileModels materialized so far"""
+        return len(self._loaded)
 
-        return list(set(types))  # Remove duplicates
@@ -5,6 +5,7 @@ Utility helpers used by the C to PlantUML converter.
 Currently, only file encoding detection is required at runtime.
 """
 
+import codecs
 import logging
 from pathlib import Path
 
@@ -17,31 +18,40 @@ except ImportError:
     CHARDET_AVAILABLE = False
 
 
+# Fallback encodings in order of preference
+FALLBACK_ENCODINGS = ["utf-8", "latin-1", "cp1252", "iso-8859-1"]
+
+
+def detect_encoding_from_bytes(raw_data: bytes, final: bool = True) -> str:
+    """Detect the encoding of a buffer holding the start of a file.
+
+    raw_data should hold the first 8 KiB of the file; final tells whether that
+    is the whole file (a split multi-byte sequence at the end is then an error).
+    """
+    if CHARDET_AVAILABLE and raw_data:
+        # Try to detect encoding with chardet on the first 1KB
+        result = chardet.detect(bytes(raw_data[:1024]))
+        if result and result["confidence"] > 0.7 and result["encoding"]:
+            return result["encoding"]
+
+    for encoding in FALLBACK_ENCODINGS:
+        try:
+            codecs.getincrementaldecoder(encoding)().decode(raw_data, final)
+            return encoding
+        except (UnicodeDecodeError, UnicodeError):
+            continue
+
+    # Final fallback
+    return "utf-8"
+
+
 def detect_file_encoding(file_path: Path) -> str:
     """Detect file encoding with platform-aware fallbacks."""
     try:
-        if CHARDET_AVAILABLE:
-            # Try to detect encoding with chardet
-            with open(file_path, "rb") as f:
-                raw_data = f.read(1024)  # Read first 1KB for detection
-                if raw_data:
-                    result = chardet.detect(raw_data)
-                    if result and result["confidence"] > 0.7:
-                        return result["encoding"]
-
-        # Fallback encodings in order of preference
-        fallback_encodings = ["utf-8", "latin-1", "cp1252", "iso-8859-1"]
-
-        for encoding in fallback_encodings:
-            try:
-                with open(file_path, "r", encoding=encoding) as f:
-                    f.read(1024)  # Test read
-                return encoding
-            except (UnicodeDecodeError, UnicodeError):
-                continue
-
-        # Final fallback
-        return "utf-8"
+        with open(file_path, "rb") as f:
+            raw_data = f.read(8192)
+            final = not f.read(1)
+        return detect_encoding_from_bytes(raw_data, final)
 
     except Exception as e:
         logging.warning(f"Failed to detect encoding for {file_path}: {e}")
@@ -0,0 +1,18 @@
+"""Feature test for parsing with multiple worker processes."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestParallelParse(UnifiedTestCase):
+    """Feature test for the parallel parse mode (config 'jobs')."""
+
+    def test_parallel_parse(self):
+        """Run the parallel parse scenario"""
+        result = self.run_test("213_parallel_parse")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,32 @@
+"""Feature test for the persistent parse cache."""
+
+import os
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestParseCache(UnifiedTestCase):
+    """Feature test for reusing cached file models on a second parse run."""
+
+    def test_parse_cache(self):
+        """Run the parse cache scenario twice and check cache reuse"""
+        result = self.run_test("214_parse_cache")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+        model_file = os.path.join(result.output_dir, "model.json")
+        with open(model_file, "r", encoding="utf-8") as f:
+            cold_model = f.read()
+
+        # Second run in the same folder must be served entirely from the cache
+        test_folder = os.path.join(result.test_dir, "input")
+        warm = self.executor.run_parse_only("config.json", test_folder)
+        self.cli_validator.assert_cli_success(warm)
+        self.assertIn("Parse cache: 3 hits, 0 misses", warm.stdout)
+
+        with open(model_file, "r", encoding="utf-8") as f:
+            self.assertEqual(cold_model, f.read())
+
+
+if __name__ == "__main__":
+    unittest.main()
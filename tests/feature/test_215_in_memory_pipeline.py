@@ -0,0 +1,18 @@
+"""Feature test for the in-memory parse/transform/generate pipeline."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestInMemoryPipeline(UnifiedTestCase):
+    """Feature test for in_memory_pipeline without intermediate model files."""
+
+    def test_in_memory_pipeline(self):
+        """Run the in-memory pipeline scenario"""
+        result = self.run_test("215_in_memory_pipeline")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
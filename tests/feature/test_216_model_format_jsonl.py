@@ -0,0 +1,44 @@
+"""Feature test for the line-delimited model format."""
+
+import os
+import unittest
+from tests.framework import UnifiedTestCase
+
+from c2puml.models import ProjectModel
+
+
+class TestModelFormatJsonl(UnifiedTestCase):
+    """Feature test for model_format jsonl with lazily loaded file models."""
+
+    def test_model_format_jsonl(self):
+        """Run the jsonl model format scenario and load the model lazily"""
+        result = self.run_test("216_model_format_jsonl")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+        model = ProjectModel.load(os.path.join(result.output_dir, "model_transformed.jsonl"))
+        self.assertEqual("model_format_jsonl_test", model.project_name)
+        self.assertEqual(["config.h", "main.c"], sorted(model.files))
+        # Nothing is materialized until a file model is accessed
+        self.assertEqual(0, model.files.loaded_count)
+        self.assertIn("main", [f.name for f in model.files["main.c"].functions])
+        self.assertEqual(1, model.files.loaded_count)
+
+    def test_model_format_jsonl_save_in_place(self):
+        """Save a lazily loaded jsonl model back to the file it was loaded from"""
+        result = self.run_test("216_model_format_jsonl")
+        self.validate_execution_success(result)
+
+        model_file = os.path.join(result.output_dir, "model.jsonl")
+        expected = ProjectModel.load(model_file).to_dict()
+
+        ProjectModel.load(model_file).save(model_file)
+
+        self.assertFalse(os.path.exists(model_file + ".tmp"))
+        reloaded = ProjectModel.load(model_file)
+        self.assertEqual(2, len(reloaded.files))
+        self.assertEqual(expected, reloaded.to_dict())
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,44 @@
+"""Feature test for generating diagrams with multiple worker processes."""
+
+import glob
+import json
+import os
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestParallelGenerate(UnifiedTestCase):
+    """Feature test for the parallel generation mode (config 'generate_jobs')."""
+
+    def _read_diagrams(self, output_dir):
+        diagrams = {}
+        for path in sorted(glob.glob(os.path.join(output_dir, "*.puml"))):
+            with open(path, "r", encoding="utf-8") as f:
+                diagrams[os.path.basename(path)] = f.read()
+        return diagrams
+
+    def test_parallel_generate(self):
+        """Run the parallel generation scenario and compare with a serial run"""
+        result = self.run_test("217_parallel_generate")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+        parallel = self._read_diagrams(result.output_dir)
+
+        # Regenerate serially from the same model; the diagrams must be byte-identical
+        test_folder = os.path.join(result.test_dir, "input")
+        config_file = os.path.join(test_folder, "config.json")
+        with open(config_file, "r", encoding="utf-8") as f:
+            config = json.load(f)
+        config["generate_jobs"] = 1
+        with open(config_file, "w", encoding="utf-8") as f:
+            json.dump(config, f)
+        serial = self.executor.run_generate_only("config.json", test_folder)
+        self.cli_validator.assert_cli_success(serial)
+        self.assertNotIn("worker processes", serial.stdout)
+
+        self.assertEqual(["main.puml", "sensor.puml", "utils.puml"], sorted(parallel))
+        self.assertEqual(parallel, self._read_diagrams(result.output_dir))
+
+
+if __name__ == "__main__":
+    unittest.main()
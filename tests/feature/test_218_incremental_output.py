@@ -0,0 +1,54 @@
+"""Feature test for incremental diagram output."""
+
+import json
+import os
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestIncrementalOutput(UnifiedTestCase):
+    """Feature test for incremental_output: unchanged diagrams are kept, orphans removed."""
+
+    def _load_manifest(self, output_dir):
+        with open(os.path.join(output_dir, "diagram_manifest.json"), "r", encoding="utf-8") as f:
+            return json.load(f)
+
+    def test_incremental_output(self):
+        """Run the incremental output scenario, then change one file and rerun"""
+        result = self.run_test("218_incremental_output")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+        output_dir = result.output_dir
+        first = self._load_manifest(output_dir)
+        self.assertEqual(["main.puml", "sensor.puml"], first["changed"])
+        self.assertEqual(["main.puml", "sensor.puml"], sorted(first["diagrams"]))
+
+        # Change only sensor.c and leave an orphaned diagram with its image behind
+        test_folder = os.path.join(result.test_dir, "input")
+        with open(os.path.join(test_folder, "src", "sensor.c"), "a", encoding="utf-8") as f:
+            f.write("int sensor_reset(void) { return 0; }\n")
+        for orphan in ("old.puml", "old.png"):
+            with open(os.path.join(output_dir, orphan), "w", encoding="utf-8") as f:
+                f.write("@startuml old\n@enduml")
+        main_puml = os.path.join(output_dir, "main.puml")
+        main_mtime = os.stat(main_puml).st_mtime_ns
+
+        rerun = self.executor.run_full_pipeline("config.json", test_folder)
+        self.cli_validator.assert_cli_success(rerun)
+        self.assertIn("Incremental output: 1 changed, 1 unchanged, 1 removed", rerun.stdout)
+
+        second = self._load_manifest(output_dir)
+        self.assertEqual(["sensor.puml"], second["changed"])
+        self.assertEqual(["old.puml"], second["removed"])
+        self.assertEqual(first["diagrams"]["main.puml"], second["diagrams"]["main.puml"])
+        self.assertNotEqual(first["diagrams"]["sensor.puml"], second["diagrams"]["sensor.puml"])
+        self.assertEqual(main_mtime, os.stat(main_puml).st_mtime_ns)
+        self.assertFalse(os.path.exists(os.path.join(output_dir, "old.puml")))
+        self.assertFalse(os.path.exists(os.path.join(output_dir, "old.png")))
+        with open(os.path.join(output_dir, "sensor.puml"), "r", encoding="utf-8") as f:
+            self.assertIn("sensor_reset", f.read())
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,18 @@
+"""Feature test for single-read source ingestion."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestSourceIngestion(UnifiedTestCase):
+    """Feature test for reading each file once, with mmap for large files."""
+
+    def test_source_ingestion(self):
+        """Run the source ingestion scenario"""
+        result = self.run_test("219_source_ingestion")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,101 @@
+"""Feature test for the --profile-report instrumentation."""
+
+import glob
+import json
+import os
+import unittest
+from tests.framework import UnifiedTestCase
+
+from c2puml.core.profiler import PROFILE_REPORT_FORMAT, Profiler
+
+
+class TestProfileReport(UnifiedTestCase):
+    """Feature test for per-stage timing and memory reports."""
+
+    def _read_diagrams(self, output_dir):
+        diagrams = {}
+        for path in sorted(glob.glob(os.path.join(output_dir, "*.puml"))):
+            with open(path, "r", encoding="utf-8") as f:
+                diagrams[os.path.basename(path)] = f.read()
+        return diagrams
+
+    def test_profile_report(self):
+        """Run the scenario, then rerun it profiled and check the report"""
+        result = self.run_test("220_profile_report")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+        unprofiled = self._read_diagrams(result.output_dir)
+
+        test_folder = os.path.join(result.test_dir, "input")
+        report_file = os.path.abspath(os.path.join(result.output_dir, "profile.json"))
+        profiled = self.executor.run_with_args(
+            "config.json", ["--profile-report", report_file, "--profile-top", "2"], test_folder
+        )
+        self.cli_validator.assert_cli_success(profiled)
+        self.assertEqual(unprofiled, self._read_diagrams(result.output_dir))
+
+        with open(report_file, "r", encoding="utf-8") as f:
+            report = json.load(f)
+        self.assertEqual(PROFILE_REPORT_FORMAT, report["format"])
+        self.assertTrue(report["memory_traced"])
+        self.assertEqual(4, report["files_parsed"])
+
+        stages = {stage["name"]: stage for stage in report["stages"]}
+        for name in (
+            "parse", "parse.tokenize", "parse.preprocess", "parse.structure_finding",
+            "parse.anonymous_processing", "parse.uses_update", "transform",
+            "transform.container", "transform.include_processing", "generate",
+            "generate.diagram",
+        ):
+            self.assertIn(name, stages)
+        self.assertEqual(4, stages["parse.tokenize"]["calls"])
+        self.assertEqual(2, stages["generate.diagram"]["calls"])
+        self.assertGreater(stages["parse"]["peak_bytes"], 0)
+
+        self.assertEqual(
+            ["main.puml", "utils.puml"],
+            sorted(item["name"] for item in report["items"]["generate.diagram"]),
+        )
+        self.assertEqual(
+            ["transformations_01_rename"],
+            [item["name"] for item in report["items"]["transform.container"]],
+        )
+
+        slowest = report["slowest_files"]
+        self.assertEqual(2, len(slowest))
+        self.assertGreaterEqual(slowest[0]["seconds"], slowest[1]["seconds"])
+        for entry in slowest:
+            self.assertGreater(entry["tokens"], 0)
+            self.assertIn("parse.tokenize", entry["stages"])
+
+    def test_worker_snapshots_merge(self):
+        """Snapshots drained from a worker profiler add up in the main profiler"""
+        worker = Profiler()
+        worker.start(trace_memory=False)
+        with worker.file("a.h"):
+            worker.note(tokens=12)
+            with worker.stage("parse.tokenize"):
+                pass
+        snapshot = worker.drain()
+        self.assertEqual({}, worker.drain()["files"])
+
+        main = Profiler()
+        main.start(trace_memory=False)
+        with main.stage("parse.tokenize"):
+            pass
+        main.merge(snapshot)
+        report = main.report()
+        stages = {stage["name"]: stage for stage in report["stages"]}
+        self.assertEqual(2, stages["parse.tokenize"]["calls"])
+        self.assertEqual(["a.h"], [entry["file"] for entry in report["slowest_files"]])
+        self.assertEqual(12, report["slowest_files"][0]["tokens"])
+
+        disabled = Profiler()
+        self.assertIsNone(disabled.drain())
+        with disabled.stage("parse"):
+            pass
+        self.assertEqual([], disabled.report()["stages"])
+
+
+if __name__ == "__main__":
+    unittest.main()
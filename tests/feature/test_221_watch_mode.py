@@ -0,0 +1,77 @@
+"""Feature test for the resident watch session behind 'c2puml watch'."""
+
+import glob
+import json
+import os
+import unittest
+from tests.framework import UnifiedTestCase
+
+from c2puml.config import Config
+from c2puml.core.watch_session import WatchSession
+
+
+class TestWatchMode(UnifiedTestCase):
+    """Feature test for incremental rebuilds of the watch command."""
+
+    def _read_diagrams(self, output_dir):
+        diagrams = {}
+        for path in sorted(glob.glob(os.path.join(output_dir, "*.puml"))):
+            with open(path, "r", encoding="utf-8") as f:
+                diagrams[os.path.basename(path)] = f.read()
+        return diagrams
+
+    def test_watch_mode(self):
+        """Incremental rebuilds match full runs and only touch affected diagrams"""
+        result = self.run_test("221_watch_mode")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+        test_folder = os.path.abspath(os.path.join(result.test_dir, "input"))
+        config_file = os.path.join(test_folder, "config.json")
+        with open(config_file, "r", encoding="utf-8") as f:
+            config_data = json.load(f)
+        config_data["source_folders"] = [
+            os.path.join(test_folder, folder) for folder in config_data["source_folders"]
+        ]
+        # Inside the output folder, so the test folder is cleaned up like any other
+        watch_output = os.path.abspath(os.path.join(result.output_dir, "watch"))
+        os.makedirs(watch_output, exist_ok=True)
+
+        session = WatchSession(
+            Config(**config_data),
+            config_file,
+            watch_output,
+            os.path.join(watch_output, "model.json"),
+            os.path.join(watch_output, "model_transformed.json"),
+        )
+        self.assertEqual(3, len(session.build()))
+        self.assertEqual(self._read_diagrams(result.output_dir), self._read_diagrams(watch_output))
+        self.assertEqual(set(), session.poll())
+
+        utils_header = os.path.join(test_folder, "src", "utils.h")
+        with open(utils_header, "a", encoding="utf-8") as f:
+            f.write("int sub(int a, int b);\n")
+        os.utime(utils_header, ns=(1, 1))
+        changed = session.poll()
+        self.assertEqual({utils_header}, changed)
+        written = session.update(changed)
+        self.assertEqual(["main.puml", "utils.puml"], sorted(os.path.basename(path) for path in written))
+
+        # The watch output equals a fresh full run on the edited sources
+        full = self.executor.run_full_pipeline("config.json", test_folder)
+        self.cli_validator.assert_cli_success(full)
+        self.assertIn("+ int sub(int a, int b)", self._read_diagrams(watch_output)["main.puml"])
+        self.assertEqual(self._read_diagrams(result.output_dir), self._read_diagrams(watch_output))
+        with open(os.path.join(result.output_dir, "model_transformed.json"), "r", encoding="utf-8") as f:
+            expected_files = json.load(f)["files"]
+        with open(os.path.join(watch_output, "model_transformed.json"), "r", encoding="utf-8") as f:
+            self.assertEqual(expected_files, json.load(f)["files"])
+
+        # Removing a root file drops its diagram
+        os.remove(os.path.join(test_folder, "src", "sensor.c"))
+        self.assertEqual([], session.update(session.poll()))
+        self.assertEqual(["main.puml", "utils.puml"], sorted(self._read_diagrams(watch_output)))
+
+
+if __name__ == "__main__":
+    unittest.main()
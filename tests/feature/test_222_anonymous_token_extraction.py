@@ -0,0 +1,18 @@
+"""Feature test for token based anonymous structure extraction."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestAnonymousTokenExtraction(UnifiedTestCase):
+    """Feature test for parsing nested anonymous structures from their tokens."""
+
+    def test_anonymous_token_extraction(self):
+        """Run the token based anonymous extraction scenario"""
+        result = self.run_test("222_anonymous_token_extraction")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,18 @@
+"""Feature test for project-wide anonymous structure deduplication."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestAnonymousDeduplication(UnifiedTestCase):
+    """Feature test for storing identical anonymous layouts once across files."""
+
+    def test_anonymous_deduplication(self):
+        """Run the anonymous deduplication scenario"""
+        result = self.run_test("223_anonymous_deduplication")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
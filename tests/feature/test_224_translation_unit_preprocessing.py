@@ -0,0 +1,18 @@
+"""Feature test for translation unit preprocessing."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestTranslationUnitPreprocessing(UnifiedTestCase):
+    """Feature test for evaluating #if against each file's own include chain."""
+
+    def test_translation_unit_preprocessing(self):
+        """Run the translation unit preprocessing scenario"""
+        result = self.run_test("224_translation_unit_preprocessing")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
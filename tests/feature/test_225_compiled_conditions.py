@@ -0,0 +1,18 @@
+"""Feature test for compiled #if conditions."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestCompiledConditions(UnifiedTestCase):
+    """Feature test for evaluating #if as C integer expressions."""
+
+    def test_compiled_conditions(self):
+        """Run the compiled conditions scenario"""
+        result = self.run_test("225_compiled_conditions")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
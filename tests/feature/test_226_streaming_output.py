@@ -0,0 +1,18 @@
+"""Feature test for streaming diagram output."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestStreamingOutput(UnifiedTestCase):
+    """Feature test for writing diagrams through a streaming sink."""
+
+    def test_streaming_output(self):
+        """Run the streaming output scenario"""
+        result = self.run_test("226_streaming_output")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,18 @@
+"""Feature test for the shared header fragment cache."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestHeaderFragmentCache(UnifiedTestCase):
+    """Feature test for reusing rendered header classes across diagrams."""
+
+    def test_header_fragment_cache(self):
+        """Run the header fragment cache scenario"""
+        result = self.run_test("227_header_fragment_cache")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
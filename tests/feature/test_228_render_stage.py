@@ -0,0 +1,18 @@
+"""Feature test for the PNG render stage."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestRenderStage(UnifiedTestCase):
+    """Feature test for rendering generated diagrams with a worker pool."""
+
+    def test_render_stage(self):
+        """Run the render stage scenario"""
+        result = self.run_test("228_render_stage")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
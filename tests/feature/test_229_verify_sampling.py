@@ -0,0 +1,18 @@
+"""Feature test for sampled model verification."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestVerifySampling(UnifiedTestCase):
+    """Feature test for verifying a stable sample of the parsed files."""
+
+    def test_verify_sampling(self):
+        """Run the verification sampling scenario"""
+        result = self.run_test("229_verify_sampling")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
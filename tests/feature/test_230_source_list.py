@@ -0,0 +1,18 @@
+"""Feature test for taking the sources from a compilation database."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestSourceList(UnifiedTestCase):
+    """Feature test for reading the source files from compile_commands.json."""
+
+    def test_source_list(self):
+        """Run the source list scenario"""
+        result = self.run_test("230_source_list")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,65 @@
+"""Feature test for sharded runs and the merge command."""
+
+import glob
+import json
+import os
+import unittest
+from tests.framework import UnifiedTestCase
+
+from c2puml.core.generator import DIAGRAM_MANIFEST
+from c2puml.core.sharding import SHARD_MANIFEST
+
+
+class TestShardedRuns(UnifiedTestCase):
+    """Feature test for partitioning the workflow over shards and merging them."""
+
+    def _read_outputs(self, output_dir):
+        outputs = {}
+        for pattern in ("*.puml", "model.json", "model_transformed.json"):
+            for path in sorted(glob.glob(os.path.join(output_dir, pattern))):
+                with open(path, "r", encoding="utf-8") as f:
+                    outputs[os.path.basename(path)] = f.read()
+        return outputs
+
+    def test_sharded_runs(self):
+        """Run the scenario unsharded, then as two shards plus merge"""
+        result = self.run_test("231_sharded_runs")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+        unsharded = self._read_outputs(result.output_dir)
+        for name in unsharded:
+            os.remove(os.path.join(result.output_dir, name))
+
+        test_folder = os.path.join(result.test_dir, "input")
+        for shard in ("1/2", "2/2"):
+            shard_result = self.executor.run_with_args("config.json", ["--shard", shard], test_folder)
+            self.cli_validator.assert_cli_success(shard_result)
+        # Shard runs only write to their shard folders
+        self.assertEqual({}, self._read_outputs(result.output_dir))
+
+        merged = self.executor.run_with_args("config.json", ["merge"], test_folder)
+        self.cli_validator.assert_cli_success(merged)
+        self.assertIn("Merged 2 shards: 6 files, 3 diagrams", merged.stdout)
+        self.assertEqual(unsharded, self._read_outputs(result.output_dir))
+
+        # Each root diagram comes from exactly one shard
+        shard_diagrams = []
+        for path in sorted(glob.glob(os.path.join(result.output_dir, "shards", "*", SHARD_MANIFEST))):
+            with open(path, "r", encoding="utf-8") as f:
+                shard_diagrams.extend(json.load(f)["diagrams"])
+        self.assertEqual(["main.puml", "sensor.puml", "utils.puml"], sorted(shard_diagrams))
+        with open(os.path.join(result.output_dir, DIAGRAM_MANIFEST), "r", encoding="utf-8") as f:
+            index = json.load(f)
+        self.assertEqual(sorted(shard_diagrams), sorted(index["shards"]))
+        self.assertEqual(sorted(shard_diagrams), sorted(index["diagrams"]))
+
+        # An incomplete set of shard outputs is refused
+        only_one = self.executor.run_with_args("config.json", ["--shard", "1/3"], test_folder)
+        self.cli_validator.assert_cli_success(only_one)
+        refused = self.executor.run_with_args("config.json", ["merge"], test_folder)
+        self.assertEqual(1, refused.exit_code)
+        self.assertIn("different plans", refused.stdout)
+
+
+if __name__ == "__main__":
+    unittest.main()
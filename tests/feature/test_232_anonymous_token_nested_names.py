@@ -0,0 +1,18 @@
+"""Feature test for token based naming of nested anonymous structures."""
+
+import unittest
+from tests.framework import UnifiedTestCase
+
+
+class TestAnonymousTokenNestedNames(UnifiedTestCase):
+    """Feature test for naming nested anonymous structures after their own parent."""
+
+    def test_anonymous_token_nested_names(self):
+        """Run the nested anonymous naming scenario"""
+        result = self.run_test("232_anonymous_token_nested_names")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -156,6 +156,26 @@ class TestExecutor:
         command = self._build_command(["--config", config_path, "--verbose"])
         return self._execute_command(command, working_dir)
 
+    def run_with_args(self, config_path: str, args: List[str], working_dir: str = None) -> CLIResult:
+        """
+        Run the complete pipeline with additional command line options
+
+        Args:
+            config_path: Path to config.json file or config directory
+            args: Extra arguments (e.g. ["--profile-report", "profile.json"])
+            working_dir: Working directory for execution (defaults to config directory)
+
+        Returns:
+            CLIResult with execution details
+        """
+        if working_dir is None:
+            working_dir = (
+                os.path.dirname(config_path) if os.path.isfile(config_path) else config_path
+            )
+
+        command = self._build_command(["--config", config_path] + list(args))
+        return self._execute_command(command, working_dir)
+
     def run_with_env_vars(self, config_path: str, env: dict, working_dir: str = None) -> CLIResult:
         """
         Run with custom environment variables
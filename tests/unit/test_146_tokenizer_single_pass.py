@@ -0,0 +1,28 @@
+#!/usr/bin/env python3
+"""
+Test Single-Pass Tokenizer Engine
+
+Verifies that parsing with the single_pass tokenizer engine handles multi-line
+comments, strings and macros through the CLI interface.
+"""
+
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", ".."))
+from tests.framework import UnifiedTestCase
+
+
+class TestTokenizerSinglePass(UnifiedTestCase):
+    """Test the single_pass tokenizer engine through the CLI interface"""
+
+    def test_tokenizer_single_pass(self):
+        """Run the single-pass tokenizer scenario"""
+        result = self.run_test("146_tokenizer_single_pass")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""
+Test Project Symbol Index
+
+Verifies the project-wide symbol index through the CLI interface and checks
+its lookups and caching on the resulting model.
+"""
+
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", ".."))
+from tests.framework import UnifiedTestCase
+
+from c2puml.core.symbol_index import ProjectSymbolIndex
+from c2puml.models import ProjectModel
+
+
+class TestSymbolIndex(UnifiedTestCase):
+    """Test the project symbol index through the CLI interface"""
+
+    def test_symbol_index(self):
+        """Run the symbol index scenario and inspect the index of the model"""
+        result = self.run_test("147_symbol_index")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+        model = ProjectModel.load(os.path.join(result.output_dir, "model_transformed.json"))
+        index = ProjectSymbolIndex.for_model(model)
+        self.assertEqual({"api_get"}, index.header_function_decl_names)
+        self.assertEqual({"api_count"}, index.header_global_names)
+        self.assertEqual("api.h", index.typedef_owner("item_t"))
+        self.assertEqual("api.h", index.find_file_key("include/api.h"))
+        self.assertIs(model.files["api.c"], index.files_by_filename["api.c"])
+        self.assertTrue(index.is_anonymous_structure("item_t_pos"))
+        self.assertTrue(index.is_anonymous_composition_pair("item_t", "item_t_pos"))
+
+        # Cached per model, rebuilt when the file set changes or on invalidate()
+        self.assertIs(index, ProjectSymbolIndex.for_model(model))
+        del model.files["api.c"]
+        rebuilt = ProjectSymbolIndex.for_model(model)
+        self.assertIsNot(index, rebuilt)
+        self.assertNotIn("api.c", rebuilt.files_by_filename)
+        ProjectSymbolIndex.invalidate(model)
+        self.assertIsNot(rebuilt, ProjectSymbolIndex.for_model(model))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+"""
+Test Transformer Pattern Engine
+
+Verifies compiled and fused rename/remove rules through the CLI interface and
+checks the engine's caching directly.
+"""
+
+import logging
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", ".."))
+from tests.framework import UnifiedTestCase
+
+from c2puml.core.pattern_engine import PatternEngine
+
+
+class TestPatternEngine(UnifiedTestCase):
+    """Test the transformer pattern engine through the CLI interface"""
+
+    def test_pattern_engine(self):
+        """Run the pattern engine scenario"""
+        result = self.run_test("148_pattern_engine")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+    def test_pattern_engine_caching(self):
+        """Pattern lists are compiled once and match like separate re.search calls"""
+        engine = PatternEngine(logging.getLogger(__name__))
+        matcher = engine.matcher(["^debug_", "_tmp$", "(?i)^TEST", "(a)\\1"])
+        self.assertIs(matcher, engine.matcher(["^debug_", "_tmp$", "(?i)^TEST", "(a)\\1"]))
+        self.assertTrue(matcher.matches("debug_dump"))
+        self.assertTrue(matcher.matches("value_tmp"))
+        self.assertTrue(matcher.matches("test_case"))
+        self.assertTrue(matcher.matches("xaay"))
+        self.assertFalse(matcher.matches("keep_me"))
+
+        rules = engine.rename_rules({"^old_(.*)": "new_\\1", "^old_x$": "unused"})
+        self.assertIs(rules, engine.rename_rules({"^old_(.*)": "new_\\1", "^old_x$": "unused"}))
+        self.assertEqual("new_x", rules.apply("old_x"))
+        self.assertEqual("other", rules.apply("other"))
+
+
+if __name__ == "__main__":
+    unittest.main()
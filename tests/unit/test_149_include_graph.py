@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+Test Include Graph
+
+Verifies include relations built from the memoized include graph through the
+CLI interface and checks closures over cyclic includes directly.
+"""
+
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", ".."))
+from tests.framework import UnifiedTestCase
+
+from c2puml.core.include_graph import IncludeGraph
+from c2puml.models import FileModel
+
+
+class TestIncludeGraph(UnifiedTestCase):
+    """Test the include graph through the CLI interface"""
+
+    def test_include_graph(self):
+        """Run the include graph scenario"""
+        result = self.run_test("149_include_graph")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+    def test_include_graph_closures(self):
+        """Closures give shortest distances through cycles and are reused"""
+        includes = {
+            "main.c": {"a.h"},
+            "a.h": {"b.h", "missing.h"},
+            "b.h": {"a.h", "c.h", "b.h"},
+            "c.h": {"d.h"},
+            "d.h": set(),
+        }
+        file_map = {
+            name: FileModel(file_path=name, name=name, includes=set(names))
+            for name, names in includes.items()
+        }
+        graph = IncludeGraph(file_map)
+        self.assertEqual(("a.h", "c.h"), graph.adjacency["b.h"])
+        self.assertEqual(("b.h",), graph.adjacency["a.h"])
+
+        view = graph.view(())
+        self.assertEqual({"a.h": 0, "b.h": 1, "c.h": 2}, view.closure("a.h", 2))
+        self.assertEqual(
+            {"main.c": 0, "a.h": 1, "b.h": 2, "c.h": 3, "d.h": 4},
+            view.closure("main.c", 10),
+        )
+        self.assertEqual({"b.h": 0, "a.h": 1, "c.h": 1, "d.h": 2}, view.closure("b.h", 5))
+        self.assertIs(view.closure("b.h", 5), view.closure("b.h", 7))
+        self.assertIs(view, graph.view(()))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+Test Type Reference Index
+
+Verifies that uses stay in sync with transformer renames and removals through
+the CLI interface and checks incremental index updates directly.
+"""
+
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", ".."))
+from tests.framework import UnifiedTestCase
+
+from c2puml.models import Alias, Field, FileModel, ProjectModel, Struct, TypeReferenceIndex
+
+
+class TestTypeReferenceIndex(UnifiedTestCase):
+    """Test the type-reference index through the CLI interface"""
+
+    def test_type_reference_index(self):
+        """Run the type-reference index scenario"""
+        result = self.run_test("150_type_reference_index")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+    def test_type_reference_index_refresh(self):
+        """Refreshing changed files updates uses in every file that references them"""
+        header = FileModel(file_path="a.h", name="a.h")
+        header.aliases["id_t"] = Alias("id_t", "unsigned int")
+        source = FileModel(file_path="b.h", name="b.h")
+        source.structs["rec_t"] = Struct("rec_t", [Field("id", "const id_t *"), Field("n", "int")])
+        source.aliases["rec_ptr_t"] = Alias("rec_ptr_t", "rec_t *")
+        model = ProjectModel(project_name="p", source_folder=".", files={"a.h": header, "b.h": source})
+
+        model.update_uses_fields()
+        self.assertEqual(["id_t"], source.structs["rec_t"].uses)
+        self.assertEqual(["rec_t"], source.aliases["rec_ptr_t"].uses)
+
+        index = TypeReferenceIndex.build(model)
+        header.aliases = {"core_id_t": Alias("core_id_t", "unsigned int")}
+        self.assertEqual(1, index.refresh(model, {"a.h"}))
+        self.assertEqual([], source.structs["rec_t"].uses)
+
+        header.aliases["id_t"] = Alias("id_t", "unsigned int")
+        self.assertEqual(1, index.refresh(model, {"a.h"}))
+        self.assertEqual(["id_t"], source.structs["rec_t"].uses)
+        self.assertEqual(0, index.refresh(model, {"a.h"}))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+Test Type Reference Map
+
+Verifies indexed cleanup and renaming of typedef references through the CLI
+interface and checks the reverse map's lookups directly.
+"""
+
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", ".."))
+from tests.framework import UnifiedTestCase
+
+from c2puml.core.type_reference_map import TypeReferenceMap
+from c2puml.models import Field, FileModel, Function, ProjectModel, Struct
+
+
+class TestTypeReferenceMap(UnifiedTestCase):
+    """Test the reverse type-reference map through the CLI interface"""
+
+    def test_type_reference_map(self):
+        """Run the type-reference map scenario"""
+        result = self.run_test("151_type_reference_map")
+        self.validate_execution_success(result)
+        self.validate_test_output(result)
+
+    def test_type_reference_map_lookups(self):
+        """Lookups return only referencing slots and follow updated types"""
+        file_model = FileModel(file_path="a.h", name="a.h")
+        file_model.functions.append(Function("open", "handle_t", [Field("flags", "const flags_t *")]))
+        file_model.globals.append(Field("count", "int"))
+        file_model.structs["dev_t"] = Struct("dev_t", [Field("h", "my_handle_t"), Field("n", "int")])
+        model = ProjectModel(project_name="p", source_folder=".", files={"a.h": file_model})
+
+        type_map = TypeReferenceMap()
+        found = type_map.slots_containing(model, {"handle_t"})
+        self.assertEqual(
+            [("return", "handle_t"), ("struct_field", "my_handle_t")],
+            [(slot.kind, slot.value) for slot in found["a.h"]],
+        )
+        words = type_map.slots_with_words(file_model, {"handle_t"})
+        self.assertEqual(["handle_t"], [slot.value for slot in words])
+
+        type_map.set_type(words[0], "void")
+        self.assertEqual("void", file_model.functions[0].return_type)
+        self.assertEqual([], type_map.slots_with_words(file_model, {"handle_t"}))
+        self.assertEqual(1, len(type_map.slots_with_words(file_model, {"void"})))
+
+
+if __name__ == "__main__":
+    unittest.main()